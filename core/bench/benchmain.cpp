@@ -0,0 +1,91 @@
+/**
+ * Runs the registered benchmarks and reports the throughput and the latency percentiles
+ *
+ * corebench [-json] [-hdr] [-interval ns] [-latency-events count] [events] [filter...]
+ * 	-json prints one JSON object per benchmark
+ * 	-hdr prints the latency percentile distribution in the HdrHistogram format
+ * 	-interval is the interval between the events of a producer in the latency run
+ * 	-latency-events is the number of events in the latency run, events / 10 by default
+ * 	events is the number of events in the throughput run
+ * 	filter runs only the benchmarks with the filter in queue/topology
+ */
+#include <benchmark>
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+
+
+static void print_text ( const isdl::benchmark& bench, const isdl::bench_result& result ) {
+	const isdl::latency_histogram& latency = result._latency;
+	std::cout << bench._queue << " " << bench._topology << " events: " << result._events 
+		<< " ops/sec: " << ( result._duration ? result._events * 1000000000 / result._duration : 0 )
+		<< " latency ns p50: " << latency.percentile ( 50 ) << " p99: " << latency.percentile ( 99 )
+		<< " p99.9: " << latency.percentile ( 99.9 ) << " max: " << latency.max () 
+		<< ( result._valid ? "" : " INVALID" ) << std::endl;
+}
+
+static void print_json ( const isdl::benchmark& bench, const isdl::bench_result& result ) {
+	const isdl::latency_histogram& latency = result._latency;
+	std::cout << "{\"queue\":\"" << bench._queue << "\",\"topology\":\"" << bench._topology 
+		<< "\",\"events\":" << result._events << ",\"duration_ns\":" << result._duration 
+		<< ",\"ops_per_sec\":" << ( result._duration ? result._events * 1000000000 / result._duration : 0 )
+		<< ",\"valid\":" << ( result._valid ? "true" : "false" )
+		<< ",\"latency_ns\":{\"count\":" << latency.count () << ",\"min\":" << latency.min () 
+		<< ",\"mean\":" << latency.mean () << ",\"p50\":" << latency.percentile ( 50 ) 
+		<< ",\"p90\":" << latency.percentile ( 90 ) << ",\"p99\":" << latency.percentile ( 99 ) 
+		<< ",\"p99.9\":" << latency.percentile ( 99.9 ) << ",\"p99.99\":" << latency.percentile ( 99.99 ) 
+		<< ",\"max\":" << latency.max () << "}}" << std::endl;
+}
+
+
+int main ( int argc, char *argv[] ) {
+	isdl::bench_config config { 10000000, -1, 1000 };
+	bool json = false;
+	bool hdr = false;
+	std::vector < std::string > filters;
+
+	for ( int arg = 1; arg < argc; ++arg ) {
+		if ( ! std::strcmp ( argv[arg], "-json" ) ) {
+			json = true;
+		} else if ( ! std::strcmp ( argv[arg], "-hdr" ) ) {
+			hdr = true;
+		} else if ( ! std::strcmp ( argv[arg], "-interval" ) && arg + 1 < argc ) {
+			config._interval = std::atoll ( argv[++arg] );
+		} else if ( ! std::strcmp ( argv[arg], "-latency-events" ) && arg + 1 < argc ) {
+			config._latency_events = std::atoll ( argv[++arg] );
+		} else if ( std::isdigit ( argv[arg][0] ) ) {
+			config._events = std::atoll ( argv[arg] );
+		} else {
+			filters.push_back ( argv[arg] );
+		}
+	}
+	if ( config._latency_events < 0 ) {
+		config._latency_events = config._events / 10;
+	}
+
+	bool valid = true;
+	for ( const isdl::benchmark& bench : isdl::benchmarks () ) {
+		std::string name = std::string ( bench._queue ) + "/" + bench._topology;
+		bool selected = filters.empty ();
+		for ( const std::string& filter : filters ) {
+			selected = selected || name.find ( filter ) != std::string::npos;
+		}
+		if ( ! selected ) continue;
+
+		isdl::bench_result result;
+		bench._function ( config, result );
+		valid = valid && result._valid;
+		if ( json ) {
+			print_json ( bench, result );
+		} else {
+			print_text ( bench, result );
+		}
+		if ( hdr ) {
+			std::cout << "# " << name << " latency in microseconds" << std::endl;
+			result._latency.print_percentiles ( std::cout );
+		}
+	}
+	return valid ? 0 : 1;
+}
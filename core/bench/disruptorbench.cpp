@@ -0,0 +1,138 @@
+/**
+ * Disruptor benchmarks. The handlers are wired in the standard topologies, the last handlers
+ * of the topology measure the hand off latency. The 2P3C topology compares the padded 
+ * sequences with the unpadded ones, build the benchmarks with BENCH_FLAGS set to
+ * -DISDL_CACHE_LINE_SIZE=8 for the unpadded layout and compare on a multi-core host
+ */
+#include <benchmark>
+#include <disruptor>
+
+
+using bench_disruptor = isdl::disruptor < isdl::bench_event, int64_t, isdl::yielding_wait_strategy >;
+
+struct bench_handler : isdl::bench_consumer {
+	bool event ( int64_t seq, isdl::bench_event& event ) {
+		consume ( event );
+		return true;
+	}
+};
+
+/// Wires the handlers in the disruptor
+using topology = void ( * ) ( bench_disruptor& disruptor, bench_handler *handlers );
+
+
+/**
+ *@brief publishes the values from 1 to events by the producers and waits until the handlers
+ * 	process all of them
+ *@return the duration in nanoseconds
+ */
+static uint64_t run ( int producers, int64_t events, uint64_t interval, topology wire, bench_handler *handlers ) {
+	uint64_t start = isdl::bench_now ();
+	{
+		bench_disruptor disruptor ( 65536 );
+		wire ( disruptor, handlers );
+		disruptor.start ();
+		std::vector < std::thread > threads;
+		for ( int producer = 0; producer < producers; ++producer ) {
+			threads.push_back ( std::thread ( [&disruptor, producer, producers, events, interval] {
+				uint64_t next = isdl::bench_now ();
+				for ( int64_t value = producer + 1; value <= events; value += producers ) {
+					uint64_t stamp = isdl::bench_pace ( next, interval );
+					int64_t seq = disruptor.next ();
+					disruptor[seq]._value = value;
+					disruptor[seq]._stamp = stamp;
+					disruptor.publish ( seq );
+				}
+			} ) );
+		}
+		for ( std::thread& thread : threads ) {
+			thread.join ();
+		}
+	}
+	return isdl::bench_now () - start;
+}
+
+
+/**
+ *@brief runs the throughput and the latency run of the topology
+ *@param handlers is the number of handlers used by the topology, every handler sees all the events
+ *@param last is the mask of the handlers measuring the latency
+ */
+static void bench ( const isdl::bench_config& config, isdl::bench_result& result, int producers, topology wire,
+	int handlers, unsigned last ) {
+	bench_handler throughput[3];
+	result._events = config._events;
+	result._duration = run ( producers, config._events, 0, wire, throughput );
+	for ( int handler = 0; handler < handlers; ++handler ) {
+		if ( throughput[handler]._sum != ( config._events + 1 ) * config._events / 2 ) {
+			result._valid = false;
+		}
+	}
+
+	isdl::latency_histogram latency[3];
+	bench_handler paced[3];
+	for ( int handler = 0; handler < handlers; ++handler ) {
+		if ( last & ( 1 << handler ) ) {
+			paced[handler]._latency = &latency[handler];
+		}
+	}
+	run ( producers, config._latency_events, config._interval, wire, paced );
+	for ( int handler = 0; handler < handlers; ++handler ) {
+		result._latency.merge ( latency[handler] );
+	}
+}
+
+
+static void one ( bench_disruptor& disruptor, bench_handler *handlers ) {
+	disruptor.first ( handlers[0] );
+}
+
+static void three ( bench_disruptor& disruptor, bench_handler *handlers ) {
+	disruptor.first ( handlers[0], handlers[1], handlers[2] );
+}
+
+static void pipeline ( bench_disruptor& disruptor, bench_handler *handlers ) {
+	disruptor.first ( handlers[0] ).then ( handlers[1] ).then ( handlers[2] );
+}
+
+static void diamond ( bench_disruptor& disruptor, bench_handler *handlers ) {
+	disruptor.first ( handlers[0], handlers[1] );
+	disruptor.after ( handlers[0], handlers[1] ).then ( handlers[2] );
+}
+
+
+void disruptor_1p1c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench ( config, result, 1, one, 1, 1 );
+}
+
+BENCHMARK ( "disruptor", "1P1C", disruptor_1p1c );
+
+void disruptor_1p3c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench ( config, result, 1, three, 3, 7 );
+}
+
+BENCHMARK ( "disruptor", "1P3C", disruptor_1p3c );
+
+void disruptor_3p1c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench ( config, result, 3, one, 1, 1 );
+}
+
+BENCHMARK ( "disruptor", "3P1C", disruptor_3p1c );
+
+void disruptor_2p3c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench ( config, result, 2, three, 3, 7 );
+}
+
+BENCHMARK ( "disruptor", "2P3C", disruptor_2p3c );
+
+void disruptor_pipeline ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench ( config, result, 1, pipeline, 3, 4 );
+}
+
+BENCHMARK ( "disruptor", "pipeline", disruptor_pipeline );
+
+void disruptor_diamond ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench ( config, result, 1, diamond, 3, 4 );
+}
+
+BENCHMARK ( "disruptor", "diamond", disruptor_diamond );
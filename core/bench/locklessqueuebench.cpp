@@ -0,0 +1,129 @@
+/**
+ * LocklessQueue benchmarks. The queue hands every event to one consumer only, so the 1P3C
+ * topology splits the events among the consumers instead of broadcasting them. The bulk
+ * variant enqueues and dequeues the events in batches
+ */
+#include <benchmark>
+#include <LocklessQueue.h>
+#include <atomic>
+#include <memory>
+
+
+static const size_t BATCH = 64;
+
+template < typename ProducerModel, typename ConsumerModel >
+using bench_queue = isdl::LocklessQueue < isdl::bench_event, 65536, ProducerModel, ConsumerModel >;
+
+
+/**
+ *@brief publishes the values from 1 to events by the producers and waits until the consumers
+ * 	dequeue all of them
+ *@param batch is the number of events enqueued and dequeued at once
+ *@return the duration in nanoseconds
+ */
+template < typename ProducerModel, typename ConsumerModel > static uint64_t run ( int producers, int64_t events,
+	uint64_t interval, size_t batch, int consumers, isdl::bench_consumer *consumed ) {
+	using queue_type = bench_queue < ProducerModel, ConsumerModel >;
+	std::unique_ptr < queue_type > queue ( new queue_type () );
+	std::atomic < int64_t > remaining ( events );
+	uint64_t start = isdl::bench_now ();
+	std::vector < std::thread > threads;
+	for ( int consumer = 0; consumer < consumers; ++consumer ) {
+		threads.push_back ( std::thread ( [&queue, &remaining, batch, &sink = consumed[consumer]] {
+			isdl::bench_event events[BATCH];
+			while ( remaining.load ( std::memory_order_relaxed ) > 0 ) {
+				size_t count = queue->dequeue_bulk ( events, batch );
+				if ( ! count ) {
+					std::this_thread::yield ();
+					continue;
+				}
+				for ( size_t index = 0; index < count; ++index ) {
+					sink.consume ( events[index] );
+				}
+				remaining.fetch_sub ( count, std::memory_order_relaxed );
+			}
+		} ) );
+	}
+	for ( int producer = 0; producer < producers; ++producer ) {
+		threads.push_back ( std::thread ( [&queue, producer, producers, events, interval, batch] {
+			isdl::bench_event pending[BATCH];
+			uint64_t next = isdl::bench_now ();
+			for ( int64_t value = producer + 1; value <= events; ) {
+				size_t count = 0;
+				for ( ; count < batch && value <= events; ++count, value += producers ) {
+					pending[count] = isdl::bench_event { value, isdl::bench_pace ( next, interval ) };
+				}
+				for ( size_t enqueued = 0; enqueued < count; ) {
+					size_t added = queue->enqueue_bulk ( pending + enqueued, count - enqueued );
+					if ( ! added ) {
+						std::this_thread::yield ();
+					}
+					enqueued += added;
+				}
+			}
+		} ) );
+	}
+	for ( std::thread& thread : threads ) {
+		thread.join ();
+	}
+	return isdl::bench_now () - start;
+}
+
+
+/**
+ *@brief runs the throughput and the latency run of the topology
+ */
+template < typename ProducerModel, typename ConsumerModel > static void bench ( const isdl::bench_config& config,
+	isdl::bench_result& result, int producers, int consumers, size_t batch ) {
+	isdl::bench_consumer throughput[3];
+	result._events = config._events;
+	result._duration = run < ProducerModel, ConsumerModel > ( producers, config._events, 0, batch, consumers,
+		throughput );
+	int64_t sum = 0;
+	for ( int consumer = 0; consumer < consumers; ++consumer ) {
+		sum += throughput[consumer]._sum;
+	}
+	result._valid = sum == ( config._events + 1 ) * config._events / 2;
+
+	isdl::latency_histogram latency[3];
+	isdl::bench_consumer paced[3];
+	for ( int consumer = 0; consumer < consumers; ++consumer ) {
+		paced[consumer]._latency = &latency[consumer];
+	}
+	run < ProducerModel, ConsumerModel > ( producers, config._latency_events, config._interval, batch, consumers,
+		paced );
+	for ( int consumer = 0; consumer < consumers; ++consumer ) {
+		result._latency.merge ( latency[consumer] );
+	}
+}
+
+
+void locklessqueue_1p1c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench < isdl::SingleThreadedModel, isdl::SingleThreadedModel > ( config, result, 1, 1, 1 );
+}
+
+BENCHMARK ( "LocklessQueue", "1P1C", locklessqueue_1p1c );
+
+void locklessqueue_1p1c_bulk ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench < isdl::SingleThreadedModel, isdl::SingleThreadedModel > ( config, result, 1, 1, BATCH );
+}
+
+BENCHMARK ( "LocklessQueue", "1P1C bulk", locklessqueue_1p1c_bulk );
+
+void locklessqueue_1p3c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench < isdl::SingleThreadedModel, isdl::MultiThreadedModel > ( config, result, 1, 3, 1 );
+}
+
+BENCHMARK ( "LocklessQueue", "1P3C", locklessqueue_1p3c );
+
+void locklessqueue_3p1c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench < isdl::MultiThreadedModel, isdl::SingleThreadedModel > ( config, result, 3, 1, 1 );
+}
+
+BENCHMARK ( "LocklessQueue", "3P1C", locklessqueue_3p1c );
+
+void locklessqueue_3p3c_bulk ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench < isdl::MultiThreadedModel, isdl::MultiThreadedModel > ( config, result, 3, 3, BATCH );
+}
+
+BENCHMARK ( "LocklessQueue", "3P3C bulk", locklessqueue_3p3c_bulk );
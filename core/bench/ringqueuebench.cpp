@@ -0,0 +1,95 @@
+/**
+ * Ring queue benchmarks. Every reader of the queue sees all the elements, so the queue
+ * supports the topologies with independent consumers only
+ */
+#include <benchmark>
+#include <ringqueue>
+#include <memory>
+
+
+template < size_t Readers > using bench_queue = isdl::ringqueue < isdl::bench_event, int64_t, 65536, Readers,
+	isdl::yielding_wait_strategy >;
+
+
+/**
+ *@brief publishes the values from 1 to events by the producers and waits until all the readers
+ * 	consume them
+ *@return the duration in nanoseconds
+ */
+template < size_t Readers > static uint64_t run ( int producers, int64_t events, uint64_t interval, 
+	isdl::bench_consumer *consumers ) {
+	std::unique_ptr < bench_queue < Readers > > queue ( new bench_queue < Readers > () );
+	uint64_t start = isdl::bench_now ();
+	std::vector < std::thread > threads;
+	for ( size_t reader = 0; reader < Readers; ++reader ) {
+		threads.push_back ( std::thread ( [&queue, reader, events, consumers] {
+			int64_t index = 0;
+			while ( index < events ) {
+				size_t count = queue->wait_committed ( index );
+				for ( size_t element = 0; element < count; ++element ) {
+					consumers[reader].consume ( (*queue)[index + element] );
+				}
+				queue->free ( reader, index, count );
+				index += count;
+			}
+		} ) );
+	}
+	for ( int producer = 0; producer < producers; ++producer ) {
+		threads.push_back ( std::thread ( [&queue, producer, producers, events, interval] {
+			uint64_t next = isdl::bench_now ();
+			for ( int64_t value = producer + 1; value <= events; value += producers ) {
+				uint64_t stamp = isdl::bench_pace ( next, interval );
+				int64_t index = queue->allocate ( 1 );
+				(*queue)[index]._value = value;
+				(*queue)[index]._stamp = stamp;
+				queue->commit ( index, 1 );
+			}
+		} ) );
+	}
+	for ( std::thread& thread : threads ) {
+		thread.join ();
+	}
+	return isdl::bench_now () - start;
+}
+
+
+template < size_t Readers > static void bench ( const isdl::bench_config& config, isdl::bench_result& result, 
+	int producers ) {
+	isdl::bench_consumer throughput[Readers];
+	result._events = config._events;
+	result._duration = run < Readers > ( producers, config._events, 0, throughput );
+	for ( size_t reader = 0; reader < Readers; ++reader ) {
+		if ( throughput[reader]._sum != ( config._events + 1 ) * config._events / 2 ) {
+			result._valid = false;
+		}
+	}
+
+	isdl::latency_histogram latency[Readers];
+	isdl::bench_consumer paced[Readers];
+	for ( size_t reader = 0; reader < Readers; ++reader ) {
+		paced[reader]._latency = &latency[reader];
+	}
+	run < Readers > ( producers, config._latency_events, config._interval, paced );
+	for ( size_t reader = 0; reader < Readers; ++reader ) {
+		result._latency.merge ( latency[reader] );
+	}
+}
+
+
+void ringqueue_1p1c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench < 1 > ( config, result, 1 );
+}
+
+BENCHMARK ( "ringqueue", "1P1C", ringqueue_1p1c );
+
+void ringqueue_1p3c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench < 3 > ( config, result, 1 );
+}
+
+BENCHMARK ( "ringqueue", "1P3C", ringqueue_1p3c );
+
+void ringqueue_3p1c ( const isdl::bench_config& config, isdl::bench_result& result ) {
+	bench < 1 > ( config, result, 3 );
+}
+
+BENCHMARK ( "ringqueue", "3P1C", ringqueue_3p1c );
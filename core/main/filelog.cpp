@@ -0,0 +1,363 @@
+/**
+ * Implementation of the file log_back
+ */
+#include <filelog>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+
+namespace isdl {
+
+
+/// Maximum number of buffers written with one writev call
+constexpr size_t LOG_MAX_IOV = 64;
+
+
+file_logback::file_logback ( const std::string& path, const file_log_options& options ) : _path { path },
+		_options { options }, _fd { -1 }, _direct { options._direct }, _tail_fd { -1 }, _current { nullptr }, _used { 0 },
+		_writing { false }, _stopping { false }, _file_size { 0 },
+		_errors { 0 } {
+	_options._buffer_size = ( _options._buffer_size + LOG_DIRECT_ALIGNMENT - 1 ) & ~( LOG_DIRECT_ALIGNMENT - 1 );
+	if ( ! _options._buffer_size ) {
+		_options._buffer_size = LOG_DIRECT_ALIGNMENT;
+	}
+	/// One buffer is filled while the writer writes the others
+	_options._buffers = std::max ( _options._buffers, size_t ( 2 ) );
+	/// The logging thread aligns the buffers handed to the writer only if the first file is
+	/// opened with O_DIRECT, the following files are opened by the writer
+	_direct = _open ();
+	for ( size_t buffer = 0; buffer < _options._buffers; ++buffer ) {
+		void *data = nullptr;
+		if ( posix_memalign ( &data, LOG_DIRECT_ALIGNMENT, _options._buffer_size ) ) {
+			for ( char *allocated : _free ) {
+				std::free ( allocated );
+			}
+			_close ();
+			throw log_file_error ( "Can not allocate log buffer", ENOMEM );
+		}
+		_free.push_back ( static_cast < char * > ( data ) );
+	}
+	_current = _free.back ();
+	_free.pop_back ();
+	_writer = std::thread ( [this] { _run (); } );
+}
+
+
+file_logback::~file_logback () {
+	if ( _used ) {
+		size_t length = _direct ? _used & ~( LOG_DIRECT_ALIGNMENT - 1 ) : _used;
+		if ( length ) {
+			_submit ( length );
+		}
+	}
+	{
+		std::lock_guard < std::mutex > lck ( _mutex );
+		_stopping = true;
+	}
+	_filled.notify_one ();
+	_writer.join ();
+	if ( _used ) {
+		/// The unaligned rest can be written only without O_DIRECT
+		_write_tail ( _output { _current, _used, true } );
+	}
+	_close ();
+	std::free ( _current );
+	for ( char *data : _free ) {
+		std::free ( data );
+	}
+}
+
+
+/**
+ *@brief opens the log file, with O_DIRECT the existing file is rotated first as the records
+ * 	can be appended only at an aligned offset. The writes are done at _file_size rather than
+ * 	appended, so a tail can be written again
+ *@return true if the file is opened with O_DIRECT
+ */
+bool file_logback::_open () {
+	struct stat status;
+	bool exists = ! stat ( _path.c_str (), &status ) && status.st_size;
+	if ( _direct && exists && status.st_size % LOG_DIRECT_ALIGNMENT ) {
+		_rotate ();
+		exists = false;
+	}
+	int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+	_fd = -1;
+	_tail_fd = -1;
+	if ( _direct ) {
+		_fd = ::open ( _path.c_str (), flags | O_DIRECT, 0644 );
+		/// The file system doesn't support O_DIRECT
+		if ( _fd < 0 && errno != EINVAL ) {
+			throw log_file_error ( "Can not open log file", errno );
+		}
+		if ( _fd >= 0 ) {
+			_tail_fd = ::open ( _path.c_str (), flags, 0644 );
+			if ( _tail_fd < 0 ) {
+				int error = errno;
+				_close ();
+				throw log_file_error ( "Can not open log file", error );
+			}
+		}
+	}
+	bool direct = _fd >= 0;
+	if ( _fd < 0 ) {
+		_fd = ::open ( _path.c_str (), flags, 0644 );
+	}
+	if ( _fd < 0 ) {
+		throw log_file_error ( "Can not open log file", errno );
+	}
+	_file_size = exists ? status.st_size : 0;
+	_opened = std::chrono::steady_clock::now ();
+	return direct;
+}
+
+
+/**
+ *@brief closes the descriptors of the log file
+ */
+void file_logback::_close () {
+	if ( _tail_fd >= 0 ) {
+		::close ( _tail_fd );
+		_tail_fd = -1;
+	}
+	if ( _fd >= 0 ) {
+		::close ( _fd );
+		_fd = -1;
+	}
+}
+
+
+/**
+ *@brief renames the log file to the first free rotated name
+ */
+void file_logback::_rotate () {
+	for ( size_t index = 1; ; ++index ) {
+		std::string rotated = _path + "." + std::to_string ( index );
+		if ( access ( rotated.c_str (), F_OK ) ) {
+			if ( rename ( _path.c_str (), rotated.c_str () ) ) {
+				++_errors;
+			}
+			return;
+		}
+	}
+}
+
+
+/**
+ *@brief writes the buffers to the file at _file_size with one call, repeats the call if it
+ * 	writes less
+ */
+void file_logback::_write ( std::vector < _output >& outputs ) {
+	for ( size_t first = 0; first < outputs.size (); first += LOG_MAX_IOV ) {
+		iovec vectors[LOG_MAX_IOV];
+		size_t count = std::min ( LOG_MAX_IOV, outputs.size () - first );
+		size_t remaining = 0;
+		for ( size_t index = 0; index < count; ++index ) {
+			vectors[index].iov_base = outputs[first + index]._data;
+			vectors[index].iov_len = outputs[first + index]._size;
+			remaining += outputs[first + index]._size;
+		}
+		iovec *vector = vectors;
+		while ( remaining ) {
+			ssize_t written = pwritev ( _fd, vector, count, _file_size );
+			if ( written < 0 ) {
+				if ( errno == EINTR ) continue;
+				++_errors;
+				break;
+			}
+			/// O_DIRECT writes have to start at an aligned offset, the partly written block
+			/// is written again
+			if ( _tail_fd >= 0 ) {
+				written &= ~static_cast < ssize_t > ( LOG_DIRECT_ALIGNMENT - 1 );
+			}
+			_file_size += written;
+			remaining -= written;
+			/// Skip the written buffers and the written part of the first unwritten one
+			while ( count && static_cast < size_t > ( written ) >= vector->iov_len ) {
+				written -= vector->iov_len;
+				++vector;
+				--count;
+			}
+			if ( count ) {
+				vector->iov_base = static_cast < char * > ( vector->iov_base ) + written;
+				vector->iov_len -= written;
+			}
+		}
+	}
+}
+
+
+/**
+ *@brief writes the tail after the end of the file without O_DIRECT, the file size isn't moved
+ * 	so the next write writes the tail again with its block
+ */
+void file_logback::_write_tail ( const _output& tail ) {
+	int fd = _tail_fd >= 0 ? _tail_fd : _fd;
+	for ( size_t written = 0; written < tail._size; ) {
+		ssize_t result = pwrite ( fd, tail._data + written, tail._size - written, _file_size + written );
+		if ( result < 0 ) {
+			if ( errno == EINTR ) continue;
+			++_errors;
+			return;
+		}
+		written += result;
+	}
+}
+
+
+void file_logback::_run () {
+	std::vector < _output > outputs;
+	std::vector < _output > blocks;
+	std::unique_lock < std::mutex > lck ( _mutex );
+	while ( true ) {
+		_filled.wait ( lck, [this] { return _stopping || ! _full.empty (); } );
+		if ( _full.empty () ) {
+			return;
+		}
+		outputs.assign ( _full.begin (), _full.end () );
+		_full.clear ();
+		_writing = true;
+		lck.unlock ();
+
+		bool rotate = ( _options._rotate_size && _file_size >= _options._rotate_size ) ||
+			( _options._rotate_interval.count () && std::chrono::steady_clock::now () - _opened >=
+			_options._rotate_interval );
+		if ( rotate && _fd >= 0 ) {
+			/// The bytes after the last whole block are written again to the next file
+			if ( _direct && ftruncate ( _fd, _file_size ) ) {
+				++_errors;
+			}
+			_close ();
+			_rotate ();
+		}
+		if ( _fd < 0 ) {
+			/// The records are lost until the file can be opened again
+			try {
+				_open ();
+			} catch ( const log_file_error& ) {
+				++_errors;
+			}
+		}
+		/// Only the last tail is written, the records of the others are in the following outputs
+		blocks.clear ();
+		for ( const _output& output : outputs ) {
+			if ( ! output._tail ) {
+				blocks.push_back ( output );
+			}
+		}
+		_write ( blocks );
+		if ( outputs.back ()._tail ) {
+			_write_tail ( outputs.back () );
+		}
+
+		lck.lock ();
+		for ( const _output& output : outputs ) {
+			_free.push_back ( output._data );
+		}
+		_writing = false;
+		_freed.notify_all ();
+	}
+}
+
+
+/**
+ *@brief returns a free buffer, waits for the writer if there is none
+ */
+char *file_logback::_acquire () {
+	std::unique_lock < std::mutex > lck ( _mutex );
+	_freed.wait ( lck, [this] { return ! _free.empty (); } );
+	char *data = _free.back ();
+	_free.pop_back ();
+	return data;
+}
+
+
+/**
+ *@brief hands the first bytes of the current buffer to the writer, the rest is moved to the
+ * 	new current buffer
+ */
+void file_logback::_submit ( size_t length ) {
+	char *next = _acquire ();
+	std::memcpy ( next, _current + length, _used - length );
+	{
+		std::lock_guard < std::mutex > lck ( _mutex );
+		_full.push_back ( _output { _current, length, false } );
+	}
+	_filled.notify_one ();
+	_current = next;
+	_used -= length;
+}
+
+
+void file_logback::_append ( const char *data, size_t length ) {
+	while ( length ) {
+		size_t copied = std::min ( length, _options._buffer_size - _used );
+		std::memcpy ( _current + _used, data, copied );
+		_used += copied;
+		data += copied;
+		length -= copied;
+		if ( _used == _options._buffer_size ) {
+			_submit ( _used );
+		}
+	}
+}
+
+
+void file_logback::add ( log_level __v, const char *__f, int __l, timestamp __t, const char *__m, size_t __s,
+		bool __b, bool __e ) {
+	if ( __b ) {
+		std::string_view time = _time.format ( __t );
+		const char *level = _log_level ( __v );
+		size_t level_length = std::strlen ( level );
+		/// Start a new buffer rather than splitting the line, unless the line doesn't fit in one
+		size_t line = time.size () + level_length + 3 + __s + 1;
+		if ( ! _direct && _used + line > _options._buffer_size && line <= _options._buffer_size ) {
+			_submit ( _used );
+		}
+		_append ( time.data (), time.size () );
+		_append ( level, level_length );
+		_append ( " : ", 3 );
+	}
+	_append ( __m, __s );
+	if ( __e ) {
+		_append ( "\n", 1 );
+	}
+}
+
+
+void file_logback::flush () {
+	size_t length = _direct ? _used & ~( LOG_DIRECT_ALIGNMENT - 1 ) : _used;
+	if ( length ) {
+		_submit ( length );
+	}
+	/// The records after the last block stay in the current buffer, the writer gets a copy
+	if ( _used ) {
+		char *tail = _acquire ();
+		std::memcpy ( tail, _current, _used );
+		{
+			std::lock_guard < std::mutex > lck ( _mutex );
+			_full.push_back ( _output { tail, _used, true } );
+		}
+		_filled.notify_one ();
+	}
+}
+
+
+size_t file_logback::errors () {
+	return _errors.load ( std::memory_order_relaxed );
+}
+
+
+void file_logback::sync () {
+	std::unique_lock < std::mutex > lck ( _mutex );
+	_freed.wait ( lck, [this] { return _full.empty () && ! _writing; } );
+}
+
+
+}
@@ -3,12 +3,18 @@
  */
 
 #include <logger>
-#include <disruptor>
+#include <cacheline>
+#include <waitstrategy>
 #include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 #include <unordered_map>
 #include <thread>
 #include <chrono>
-#include <iomanip>
 #include <iostream>
 
 
@@ -39,61 +45,96 @@ _log_level::operator const char *() {
 }
 
 
-constexpr size_t LOG_QUEUE_SIZE_POWER_OF_TWO = 17;
-constexpr size_t LOG_BUFFER_SIZE = 100;
+/// Bytes of the staging buffer of every logging thread
+constexpr size_t LOG_STAGING_SIZE = 1 << 16;
+/// Longest record, the longer messages are truncated. A record wrapping around the end of the
+/// staging buffer is moved to its start, half of the buffer is always enough for that
+constexpr size_t LOG_MAX_RECORD = LOG_STAGING_SIZE / 2;
+/// Size of the record telling that the records continue at the start of the staging buffer
+constexpr size_t LOG_WRAP = ~size_t ( 0 );
 constexpr const char  *DEFAULT_TIME_FORMAT = "%Y-%b-%d-%H:%M:%S.";
+/// Interval after which the rate of the time stamp counter is measured again
+constexpr std::chrono::nanoseconds LOG_TSC_CALIBRATION = std::chrono::seconds ( 1 );
 
 constexpr log_level default_log_level = log_level::info;
 
 
 
 /**
- *@brief Captures logging information
+ *@brief Captures logging information, the header of a variable length record in the staging
+ * 	buffer. The message or the captured arguments follow the header
  */
-struct log_event {
+struct log_record {
+	/// Bytes taken by the record including the header, LOG_WRAP for the wrap marker
+	size_t _size;
 	log_level _level;
         log_back  *_back;
         const char *_file_name;
         int _src_line_number; 
-        timestamp _timestamp;
-        bool _end_of_batch; 
-        seq_t _prev_batch_seq;
-        char _msg[LOG_BUFFER_SIZE];
+        log_ticks _ticks;
+        /// Formats the captured arguments of a deferred record, nullptr if the record is the text
+        log_formatter _formatter;
         size_t _msg_len;
 
+	char *message () {
+		return reinterpret_cast < char * > ( this + 1 );
+	}
 };
 
 /**
- *@brief Disruptor wait strategy 
+ *@brief returns the bytes taken by a record with the message length, records start aligned
  */
-struct WaitStrategy {
-	void wait () {
-		std::this_thread::yield();
-	}
+constexpr size_t record_size ( size_t msg_len ) {
+	return ( sizeof ( log_record ) + msg_len + alignof ( log_record ) - 1 ) & ~( alignof ( log_record ) - 1 );
+}
+
+/**
+ *@brief Wait strategy of the staging buffers, the background thread is parked when there is
+ * 	nothing to log
+ */
+using WaitStrategy = phased_backoff_wait_strategy <>;
 
-	void notify () {
-	}
-};
 
 
 
+std::string_view log_time_format::format ( timestamp __t ) {
+	auto since_epoch = __t.time_since_epoch ();
+	time_t second = std::chrono::duration_cast < std::chrono::seconds > ( since_epoch ).count ();
+	if ( second != _second ) {
+		tm local_time;
+		localtime_r ( &second, &local_time );
+		_length = strftime ( _text, sizeof ( _text ) - 4, DEFAULT_TIME_FORMAT, &local_time );
+		_second = second;
+	}
+	unsigned millisecond = std::chrono::duration_cast < std::chrono::milliseconds > ( since_epoch ).count () % 1000;
+	_text[_length] = '0' + millisecond / 100;
+	_text[_length + 1] = '0' + millisecond / 10 % 10;
+	_text[_length + 2] = '0' + millisecond % 10;
+	_text[_length + 3] = ' ';
+	return std::string_view ( _text, _length + 4 );
+}
+
 
 static class basic_logback : public log_back {
+	log_time_format _time;
 public:
 	virtual void add ( log_level __v, const char *__f, int __l, timestamp __t,  const char *__m,
 		size_t __s, bool __b, bool __e ) {
 		if ( __b ) {
-			time_t local_time = std::chrono::system_clock::to_time_t ( __t );
-			std::cout << std::put_time ( std::localtime ( &local_time ), 
-				DEFAULT_TIME_FORMAT ) << 
-			std::chrono::duration_cast<std::chrono::milliseconds>(__t.time_since_epoch() ).count() % 1000 <<" : ";
+			std::string_view time = _time.format ( __t );
+			std::cout.write ( time.data (), time.size () );
+			std::cout << ": ";
 		}
 		std::cout.write ( __m, __s );
 		if ( __e ) {
-			std::cout << std::endl;
+			std::cout << '\n';
 		}
 		
 	}
+
+	virtual void flush () {
+		std::cout.flush ();
+	}
 } default_logback;
 
 class logger : public basic_logger  {
@@ -115,50 +156,421 @@ static std::unordered_map < std::string, logger > _log_backs;
 
 
 
-disruptor < log_event, int64_t, WaitStrategy> _disruptor ( 2 << LOG_QUEUE_SIZE_POWER_OF_TWO );
+/**
+ *@brief Stream buffer receiving the messages formatted by the background thread, the memory
+ * 	is reused by the following messages
+ */
+class format_buffer : public std::basic_streambuf < char, std::char_traits < char > > {
 
-struct log_handler {
+	std::string _text;
 
-	void process_event ( int64_t seq, log_event& ev ) {
+protected:
+	virtual std::streamsize xsputn ( const char_type *__s, std::streamsize __n ) {
+		_text.append ( __s, __n );
+		return __n;
+	}
 
-		int64_t prev_seq = ev._prev_batch_seq;
+	virtual int_type overflow ( int_type __c ) {
+		if ( ! traits_type::eq_int_type ( __c, traits_type::eof () ) ) {
+			_text.push_back ( traits_type::to_char_type ( __c ) );
+		}
+		return __c;
+	}
 
-		if ( prev_seq != seq ) {
+public:
+	std::string& text () {
+		return _text;
+	}
+};
+
+
+/**
+ *@brief Wakes up the background thread when a logging thread publishes a record
+ */
+static WaitStrategy _drain_signal;
+
+
+/**
+ *@brief Staging buffer of a logging thread. The thread is the only writer and the background
+ * 	thread the only reader, so the logging threads never contend with each other. The
+ * 	records are contiguous and take only the bytes of their message, a record which doesn't
+ * 	fit before the end of the buffer is preceded by a wrap marker and starts at the beginning
+ * 	of the buffer. The positions grow monotonically and are mapped to the buffer modulo its size
+ */
+struct log_staging {
+	static constexpr size_t MASK = LOG_STAGING_SIZE - 1;
+
+	std::unique_ptr < char [] > _data { new char [LOG_STAGING_SIZE] };
+	/// End of the published records, written by the logging thread
+	padded < std::atomic < size_t > > _head;
+	/// End of the processed records, written by the background thread
+	padded < std::atomic < size_t > > _tail;
+	/// Wakes up the logging thread waiting for free space
+	WaitStrategy _space;
+	/// Set when the thread exits, the buffer is released once the background thread drains it
+	std::atomic < bool > _closed { false };
+	/// Position up to which the buffer is known to be free, used by the logging thread only
+	size_t _limit = LOG_STAGING_SIZE;
+	/// First record not processed yet, used by the background thread only
+	size_t _read = 0;
+
+	char *at ( size_t position ) {
+		return &_data[position & MASK];
+	}
+
+	log_record *record ( size_t position ) {
+		return reinterpret_cast < log_record * > ( at ( position ) );
+	}
 
-			process_event ( prev_seq, _disruptor[prev_seq] );
-			ev._back->add ( ev._level, ev._file_name, ev._src_line_number,
-			ev._timestamp, ev._msg, ev._msg_len, false, ev._end_of_batch );
+	/**
+	 *@brief returns the position following the end of the buffer the position is mapped to
+	 */
+	static size_t wrap ( size_t position ) {
+		return ( position | MASK ) + 1;
+	}
+
+	/**
+	 *@brief waits until the background thread frees the buffer up to the end position
+	 */
+	void reserve ( size_t end ) {
+		if ( end > _limit ) {
+			wait_until ( _space, [this, end] {
+				return end <= ( _limit = _tail._value.load ( std::memory_order_acquire ) + LOG_STAGING_SIZE );
+			} );
+		}
+	}
 
+	/**
+	 *@brief passes the records up to the end position to the background thread
+	 */
+	void publish ( size_t end ) {
+		_head._value.store ( end, std::memory_order_release );
+		_drain_signal.notify ();
+	}
+
+	/**
+	 *@brief frees the records processed by the background thread up to the end position
+	 */
+	void free ( size_t end ) {
+		_tail._value.store ( end, std::memory_order_release );
+		_space.notify ();
+	}
+};
+
+
+/**
+ *@brief Staging buffers of all the logging threads
+ */
+static struct log_registry {
+	std::mutex _mutex;
+	std::vector < std::shared_ptr < log_staging > > _buffers;
+	/// Changed whenever a buffer is added or removed
+	std::atomic < size_t > _version { 0 };
+} _registry;
+
+/**
+ *@brief Registers the staging buffer of the thread when the thread logs for the first time
+ */
+struct staging_holder {
+	std::shared_ptr < log_staging > _staging;
+
+	staging_holder () : _staging { std::make_shared < log_staging > () } {
+		std::lock_guard < std::mutex > lck ( _registry._mutex );
+		_registry._buffers.push_back ( _staging );
+		_registry._version.fetch_add ( 1, std::memory_order_release );
+	}
+
+	~staging_holder () {
+		_staging->_closed.store ( true, std::memory_order_release );
+		_drain_signal.notify ();
+	}
+};
+
+static log_staging *_thread_staging () {
+	thread_local staging_holder holder;
+	return holder._staging.get ();
+}
+
+
+/**
+ *@brief Converts the log_ticks of the records to the system clock, used by the background
+ * 	thread only. The rate of the time stamp counter is measured over the interval since the
+ * 	previous calibration, the records are converted relative to the latest calibration
+ */
+class log_clock {
+	/// Counter and system clock read at the same time at the latest calibration
+	log_ticks _ticks = 0;
+	int64_t _nanoseconds = 0;
+	/// Nanoseconds per counter tick, 0 until the first calibration
+	double _rate = 0;
+	/// Counter of the next calibration
+	log_ticks _next = 0;
+	/// Latest converted time, a new calibration must not move the times back
+	int64_t _converted = 0;
+
+	static void _sample ( log_ticks& ticks, int64_t& nanoseconds ) {
+		log_ticks before = log_now ();
+		nanoseconds = std::chrono::duration_cast < std::chrono::nanoseconds > (
+			std::chrono::system_clock::now ().time_since_epoch () ).count ();
+		ticks = before + ( log_now () - before ) / 2;
+	}
+
+	void _calibrate () {
+		log_ticks ticks;
+		int64_t nanoseconds;
+		do {
+			if ( ! _rate ) {
+				_sample ( _ticks, _nanoseconds );
+				std::this_thread::sleep_for ( std::chrono::milliseconds ( 10 ) );
+			}
+			_sample ( ticks, nanoseconds );
+			/// Keep the previous rate if the system clock was set back, the first sample is
+			/// taken again until there is a rate
+			if ( ticks > _ticks && nanoseconds > _nanoseconds ) {
+				_rate = double ( nanoseconds - _nanoseconds ) / ( ticks - _ticks );
+			}
+		} while ( ! _rate );
+		_ticks = ticks;
+		_nanoseconds = nanoseconds;
+		_next = ticks + static_cast < log_ticks > ( LOG_TSC_CALIBRATION.count () / _rate );
+	}
+
+public:
+	timestamp time ( log_ticks __t ) {
+		if constexpr ( ! LOG_TSC_TIMESTAMP ) {
+			return timestamp ( timestamp::duration ( __t ) );
+		}
+		if ( __t >= _next ) {
+			_calibrate ();
+		}
+		_converted = std::max ( _converted, _nanoseconds + static_cast < int64_t > ( ( __t - _ticks ) * _rate ) );
+		return timestamp ( std::chrono::duration_cast < timestamp::duration > ( std::chrono::nanoseconds ( _converted ) ) );
+	}
+};
+
+
+struct log_handler {
+
+	format_buffer _buffer;
+	std::basic_ostream < char, std::char_traits < char > > _stream { &_buffer };
+	/// Initial state of the stream, restored before every deferred record
+	std::ios_base::fmtflags _flags { _stream.flags () };
+	char _fill { _stream.fill () };
+	std::streamsize _precision { _stream.precision () };
+	/// log_backs which received records since the last flush
+	std::vector < log_back * > _batch;
+	log_clock _clock;
+
+	/**
+	 *@brief flushes the log_backs which received records in the batch
+	 */
+	void end_batch () {
+		for ( log_back *back : _batch ) {
+			back->flush ();
+		}
+		_batch.clear ();
+	}
+
+	/**
+	 *@brief passes the message of the record to the log_back, formats the deferred records
+	 */
+	void process ( log_record& record ) {
+		if ( std::find ( _batch.begin (), _batch.end (), record._back ) == _batch.end () ) {
+			_batch.push_back ( record._back );
+		}
+		timestamp time = _clock.time ( record._ticks );
+		if ( record._formatter ) {
+			_buffer.text ().clear ();
+			/// The stream is shared by all the records, a record must not see the state another
+			/// one left
+			_stream.flags ( _flags );
+			_stream.fill ( _fill );
+			_stream.precision ( _precision );
+			_stream.width ( 0 );
+			record._formatter ( _stream, record.message () );
+			record._back->add ( record._level, record._file_name, record._src_line_number, time,
+				_buffer.text ().data (), _buffer.text ().size (), true, true );
 		} else {
+			record._back->add ( record._level, record._file_name, record._src_line_number, time,
+				record.message (), record._msg_len, true, true );
+		}
+	}
+
+};
+
+
+/**
+ *@brief Background thread merging the staging buffers of the logging threads. The messages
+ * 	ready in the buffers are passed to the log_backs in the order of their timestamps
+ */
+class log_drainer {
+
+	log_handler _handler;
+	/// Copy of the registered buffers, refreshed when the registry changes
+	std::vector < std::shared_ptr < log_staging > > _buffers;
+	size_t _version = 0;
+	std::atomic < bool > _stopping { false };
+	/// Number of the sync calls and the number of them served by a completed drain
+	std::atomic < uint64_t > _sync_requests { 0 };
+	std::atomic < uint64_t > _sync_served { 0 };
+	std::mutex _sync_mutex;
+	std::condition_variable _synced;
+	std::thread _thread;
+
+	void _refresh () {
+		if ( _registry._version.load ( std::memory_order_acquire ) != _version ) {
+			std::lock_guard < std::mutex > lck ( _registry._mutex );
+			_buffers = _registry._buffers;
+			_version = _registry._version.load ( std::memory_order_relaxed );
+		}
+	}
 
-			ev._back->add ( ev._level, ev._file_name, ev._src_line_number,
-			ev._timestamp, ev._msg, ev._msg_len, true, ev._end_of_batch );
+	/**
+	 *@brief returns the first record published in the buffer, nullptr if there is none
+	 */
+	log_record *_message ( log_staging& staging ) {
+		size_t head = staging._head._value.load ( std::memory_order_acquire );
+		while ( staging._read != head ) {
+			log_record *record = staging.record ( staging._read );
+			if ( record->_size != LOG_WRAP ) {
+				return record;
+			}
+			staging._read = log_staging::wrap ( staging._read );
 		}
+		return nullptr;
 	}
-	
-	bool event ( int64_t seq, log_event& ev ) {
-		if ( ! ev._end_of_batch ) 
-			return false;
-		process_event ( seq, ev );
-		return true;
+
+	/**
+	 *@brief releases the buffers of the exited threads which are drained
+	 */
+	void _release () {
+		std::lock_guard < std::mutex > lck ( _registry._mutex );
+		auto& buffers = _registry._buffers;
+		size_t size = buffers.size ();
+		buffers.erase ( std::remove_if ( buffers.begin (), buffers.end (), [] ( const std::shared_ptr < log_staging >& staging ) {
+			return staging->_closed.load ( std::memory_order_acquire ) &&
+				staging->_head._value.load ( std::memory_order_acquire ) == staging->_read;
+		} ), buffers.end () );
+		if ( buffers.size () != size ) {
+			_registry._version.fetch_add ( 1, std::memory_order_release );
+		}
 	}
 
-} handler;
-	
+	/**
+	 *@brief passes the ready messages to the log_backs
+	 *@return true if any buffer had a message
+	 */
+	bool _drain () {
+		bool drained = false;
+		bool closed = false;
+		while ( true ) {
+			log_staging *next = nullptr;
+			log_record *next_record = nullptr;
+			for ( const std::shared_ptr < log_staging >& staging : _buffers ) {
+				log_record *record = _message ( *staging );
+				if ( record && ( ! next || record->_ticks < next_record->_ticks ) ) {
+					next = staging.get ();
+					next_record = record;
+				}
+				closed = closed || ( ! record && staging->_closed.load ( std::memory_order_acquire ) );
+			}
+			if ( ! next ) break;
+			_handler.process ( *next_record );
+			next->_read += next_record->_size;
+			next->free ( next->_read );
+			drained = true;
+		}
+		_handler.end_batch ();
+		if ( closed ) {
+			_release ();
+		}
+		return drained;
+	}
+
+	/**
+	 *@brief returns true if a buffer has a message or a buffer can be released, the check
+	 * 	doesn't process the messages as the blocking wait strategies call it under their lock
+	 */
+	bool _ready () {
+		if ( _sync_requests.load ( std::memory_order_acquire ) != _sync_served.load ( std::memory_order_relaxed ) ) {
+			return true;
+		}
+		_refresh ();
+		for ( const std::shared_ptr < log_staging >& staging : _buffers ) {
+			if ( _message ( *staging ) || staging->_closed.load ( std::memory_order_acquire ) ) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void _run () {
+		while ( true ) {
+			wait_until ( _drain_signal, [this] {
+				return _stopping.load ( std::memory_order_acquire ) || _ready ();
+			} );
+			/// The buffers are refreshed after reading the requests, so the drain sees the
+			/// records published before them
+			uint64_t requests = _sync_requests.load ( std::memory_order_acquire );
+			_refresh ();
+			_drain ();
+			_serve ( requests );
+			/// The logging threads are done when stopping, exit once everything is logged
+			if ( _stopping.load ( std::memory_order_acquire ) ) {
+				return;
+			}
+		}
+	}
 
+	/**
+	 *@brief wakes up the sync calls made before the completed drain
+	 */
+	void _serve ( uint64_t requests ) {
+		if ( requests != _sync_served.load ( std::memory_order_relaxed ) ) {
+			{
+				std::lock_guard < std::mutex > lck ( _sync_mutex );
+				_sync_served.store ( requests, std::memory_order_relaxed );
+			}
+			_synced.notify_all ();
+		}
+	}
+
+public:
+	log_drainer () : _thread { [this] { _run (); } } {}
+
+	/**
+	 *@brief waits until the records published before the call are passed to the log_backs
+	 * 	and the log_backs are flushed
+	 */
+	void sync () {
+		uint64_t request = _sync_requests.fetch_add ( 1, std::memory_order_acq_rel ) + 1;
+		_drain_signal.notify ();
+		std::unique_lock < std::mutex > lck ( _sync_mutex );
+		_synced.wait ( lck, [this, request] { 
+			return _sync_served.load ( std::memory_order_relaxed ) >= request; } );
+	}
+
+	~log_drainer () {
+		_stopping.store ( true, std::memory_order_release );
+		_drain_signal.notify ();
+		_thread.join ();
+	}
+};
 
 
 /**
  * @brief implementation of logger factory
  */
 struct default_logger_factory : public logger_factory {
-	default_logger_factory () {
-		_disruptor.first ( handler );
-		_disruptor.start ();
-		 
-	}
+	log_drainer _drainer;
+
 	virtual basic_logger& get_logger ( const char *back_name );
 	virtual void add_logger ( const char *name, log_back *back, log_level level );
+	virtual void remove_logger ( const char *name );
+
+	virtual void sync () {
+		_drainer.sync ();
+	}
 
 } _log_factory;
 
@@ -201,91 +613,124 @@ void default_logger_factory::add_logger ( const char *name, log_back *back, log_
 	 
 }
 
+/**
+ *@brief removes the logger configuration, get_logger returns the default logger for the name
+ *@param name is the configuration name
+ */
+void default_logger_factory::remove_logger ( const char *name ) {
+	_log_backs.erase ( std::string ( name ) );
+}
 
+
+/**
+ *@brief starts the record at the head of the staging buffer
+ */
 void log_buffer::_init_ptrs () {
-	_curr_seq = _disruptor.next();
-	log_event& ev = _disruptor [_curr_seq];
-	ev._end_of_batch = true;
-	ev._prev_batch_seq = _curr_seq;
-	ev._msg_len = 0;
-	ev._back = _back;
-	/// Initialize the inherited members
-	_M_out_beg = ev._msg; 
-	_M_out_cur = _M_out_beg;
-	_M_out_end = _M_out_beg+LOG_BUFFER_SIZE;	
+	size_t start = _staging->_head._value.load ( std::memory_order_relaxed );
+	if ( log_staging::wrap ( start ) - start < record_size ( 0 ) ) {
+		/// The header doesn't fit before the end of the buffer
+		_staging->reserve ( start + sizeof ( size_t ) );
+		_staging->record ( start )->_size = LOG_WRAP;
+		start = log_staging::wrap ( start );
+	}
+	_staging->reserve ( start + record_size ( 0 ) );
+	_record = start;
+	log_record& record = *_staging->record ( _record );
+	record._back = _back;
+	record._formatter = nullptr;
+	setp ( record.message (), record.message () );
+	_grow ( 0 );
+}
+
+/**
+ *@brief extends the put area by the free space following it, waits for the background thread
+ * 	to free the space if there is less than requested
+ *@param __n is the number of bytes requested
+ *@return the number of bytes available in the put area, less than requested only if the
+ * 	record reached LOG_MAX_RECORD
+ */
+size_t log_buffer::_grow ( size_t __n ) {
+	size_t used = pptr () - pbase ();
+	size_t end = _record + record_size ( used + __n );
+	if ( end > _record + LOG_MAX_RECORD ) {
+		end = _record + LOG_MAX_RECORD;
+	}
+	if ( end > log_staging::wrap ( _record ) ) {
+		/// Move the record to the start of the buffer and mark its old position
+		size_t start = log_staging::wrap ( _record );
+		end = start + ( end - _record );
+		_staging->reserve ( end );
+		std::memcpy ( _staging->at ( start ), _staging->at ( _record ), sizeof ( log_record ) + used );
+		_staging->record ( _record )->_size = LOG_WRAP;
+		_record = start;
+	} else {
+		_staging->reserve ( end );
+	}
+	/// Expose all the space known to be free, up to the end of the buffer
+	size_t limit = std::min ( { _staging->_limit, log_staging::wrap ( _record ), _record + LOG_MAX_RECORD } );
+	char *message = _staging->record ( _record )->message ();
+	setp ( message, message + ( limit - _record - sizeof ( log_record ) ) );
+	pbump ( static_cast < int > ( used ) );
+	return epptr () - pptr ();
+}
+
+void log_buffer::_publish () {
+	log_record& record = *_staging->record ( _record );
+	record._msg_len = pptr () - pbase ();
+	record._size = record_size ( record._msg_len );
+	_staging->publish ( _record + record._size );
 }
 
 log_buffer::log_buffer ( log_level __v, log_back *__b, const char *__f, 
-			int __l, timestamp __t ) : 
-		_back { __b }  {
+			int __l, log_ticks __t ) : 
+		_back { __b }, _staging { _thread_staging () }  {
 	_init_ptrs();
-	/// Mark this entry as end of batch first
-	/// And change it later on if we need a batch with more
-	/// than one entry
-	log_event& ev = _disruptor [_curr_seq];
-	ev._level = __v;
-	ev._back = _back;
-	ev._file_name = __f;
-	ev._src_line_number = __l;
-	ev._timestamp = __t;
-	_M_in_beg = nullptr;
-	_M_in_cur = nullptr;
-	_M_in_end = nullptr;
-		
-		
+	log_record& record = *_staging->record ( _record );
+	record._level = __v;
+	record._file_name = __f;
+	record._src_line_number = __l;
+	record._ticks = __t;
+	setg ( nullptr, nullptr, nullptr );
+}
+
+bool log_buffer::defer ( log_formatter __fmt, size_t __size ) {
+	if ( record_size ( __size ) > LOG_MAX_RECORD ) {
+		return false;
+	}
+	if ( static_cast < size_t > ( epptr () - pptr () ) < __size ) {
+		_grow ( __size );
+	}
+	log_record& record = *_staging->record ( _record );
+	record._formatter = __fmt;
+	return true;
 }
 
 /**
- *@brief insert multiple character in the buffer
+ *@brief insert multiple character in the buffer, the characters beyond LOG_MAX_RECORD are
+ * 	dropped
  */
 std::streamsize log_buffer::xsputn ( const char_type *__s, std::streamsize __n ) {
-	size_t cpy_len = __n;
-	
-	/// Set the message length based on the difference between the 
-	/// beginning pointer and the curr pointer. This is the only relyable way
-	/// of getting the length of the buffer
-	_disruptor [ _curr_seq ]._msg_len = _M_out_cur - _M_out_beg;
-	size_t remaining_size = LOG_BUFFER_SIZE - _disruptor[_curr_seq]._msg_len;
-	/// Check if we have enough space to copy the whole buffer
-	while ( cpy_len > remaining_size ) { /// Overflow the buffer 
-		std::memcpy ( _M_out_cur, __s, remaining_size );
-		__s += remaining_size;
-		cpy_len -= remaining_size;
-		_disruptor [_curr_seq ]._msg_len += remaining_size;
-		_disruptor [_curr_seq ]._end_of_batch = false;
-		_disruptor.publish( _curr_seq);
-		auto seq = _curr_seq;
-		/// _init_ptrs changes the value of _curr_seq with newelly allocated 
-		/// sequence
-		_init_ptrs ();
-		_disruptor[_curr_seq]._prev_batch_seq = seq;
-		remaining_size = LOG_BUFFER_SIZE;
-		
+	size_t available = epptr () - pptr ();
+	if ( available < static_cast < size_t > ( __n ) ) {
+		available = _grow ( __n );
 	}
-	/// Insert the rest of the data
-	if ( cpy_len > 0 ) {
-		std::memcpy ( _M_out_cur, __s, cpy_len );
-		_M_out_cur += cpy_len;
-		_disruptor [_curr_seq]._msg_len += cpy_len;
-	} 
-
+	size_t cpy_len = std::min ( available, static_cast < size_t > ( __n ) );
+	std::memcpy ( pptr (), __s, cpy_len );
+	pbump ( static_cast < int > ( cpy_len ) );
 	return __n;
-
-
-
-
 }
 
 /**
- *@brief called when overflow occurs. Gets a new slot and caries on
+ *@brief called when the put area is full, extends it and caries on
  */
 log_buffer::int_type log_buffer::overflow(log_buffer::int_type __c ) {
-	_disruptor[_curr_seq]._msg_len = _M_out_cur - _M_out_beg;
-	_disruptor[_curr_seq]._end_of_batch = false;
-	_disruptor.publish ( _curr_seq, 1 );
-	auto seq = _curr_seq;
-	_init_ptrs ();
-	*_M_out_cur++ = __c;
+	if ( traits_type::eq_int_type ( __c, traits_type::eof () ) ) {
+		return traits_type::not_eof ( __c );
+	}
+	if ( _grow ( 1 ) ) {
+		*pptr () = traits_type::to_char_type ( __c );
+		pbump ( 1 );
+	}
 	return __c;
 }
 
@@ -294,8 +739,7 @@ log_buffer::int_type log_buffer::overflow(log_buffer::int_type __c ) {
  * 	Makes sure that the last data is committed
  */
 log_buffer::~log_buffer () {
-	_disruptor[_curr_seq]._msg_len = _M_out_cur - _M_out_beg;
-	_disruptor.publish ( _curr_seq );
+	_publish ();
 }
 
 
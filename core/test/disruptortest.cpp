@@ -258,7 +258,956 @@ void disruptor4 () {
 	ASSERT_EQUAL( after_handler2.accumulated, (100000001L*50000000L), "Check accumulated count of after handler 2" );
 	ASSERT_EQUAL( after_handler3.accumulated, (100000001L*50000000L), "Check accumulated count of after handler 3" );
 
+	/// The after handler receives the last event of a burst without waiting for more events
+	struct EventCounter {
+		std::atomic < int64_t > events { 0 };
+		bool event ( int64_t seq, my_event& event ) {
+			++events;
+			return true;
+		}
+	} first_counter, after_counter;
+	{
+		isdl::disruptor< my_event, int64_t, my_wait_strategy > testdisruptor ( 1024 );
+		testdisruptor.first ( first_counter ).then ( after_counter );
+		testdisruptor.start();
+		for ( int64_t i = 0; i < 10; ++i ) {
+			int64_t seq = testdisruptor.next();
+			testdisruptor[seq]._value = i;
+			testdisruptor.publish ( seq );
+		}
+		auto deadline = std::chrono::steady_clock::now () + std::chrono::seconds ( 1 );
+		while ( after_counter.events.load () < 10 && std::chrono::steady_clock::now () < deadline ) {
+			std::this_thread::yield ();
+		}
+		ASSERT_EQUAL( after_counter.events.load (), 10, "After handler receives the last event of the burst" );
+	}
 }
 
 TEST ( "Test after handler", disruptor4 );
 
+
+/**
+ * Runs one producer three consumers scenario with the specified wait strategy
+ */
+template < typename WaitStrategy > void _wait_strategy_test ( int64_t events ) {
+	struct EventHandler {
+		int64_t accumulated = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			accumulated += value;
+			return true;
+		}
+	} handler1 , handler2 , handler3 ;
+
+	{
+		isdl::disruptor< int64_t, int64_t, WaitStrategy > testdisruptor ( 1024 );
+	
+		testdisruptor.first( handler1, handler2, handler3 );
+		
+		testdisruptor.start();
+
+		for ( int64_t i = 1; i <= events; ++i ) {
+			int64_t seq = testdisruptor.next();
+			testdisruptor[seq]=i;
+			testdisruptor.publish ( seq ); 
+		}
+	}
+	ASSERT_EQUAL( handler1.accumulated, (events+1)*events/2, "Check accumulated value for the first handler" );
+	ASSERT_EQUAL( handler2.accumulated, (events+1)*events/2, "Check accumulated value for the second handler" );
+	ASSERT_EQUAL( handler3.accumulated, (events+1)*events/2, "Check accumulated value for the third handler" );
+}
+
+void disruptor5 () {
+	_wait_strategy_test < isdl::busy_spin_wait_strategy > ( 100000 );
+}
+
+TEST ( "Test busy spin wait strategy", disruptor5 );
+
+void disruptor6 () {
+	_wait_strategy_test < isdl::yielding_wait_strategy > ( 1000000 );
+}
+
+TEST ( "Test yielding wait strategy", disruptor6 );
+
+void disruptor7 () {
+	_wait_strategy_test < isdl::blocking_wait_strategy > ( 1000000 );
+}
+
+TEST ( "Test blocking wait strategy", disruptor7 );
+
+void disruptor8 () {
+	_wait_strategy_test < isdl::phased_backoff_wait_strategy<> > ( 1000000 );
+}
+
+TEST ( "Test phased backoff wait strategy", disruptor8 );
+
+/**
+ * Single producer feeding two groups of handlers
+ */
+void disruptor9 () {
+	struct my_event {
+		int64_t _value;
+		int64_t _final;
+	};
+
+	struct EventHandler {
+		bool event ( int64_t seq, my_event& event ) {
+			event._final = event._value;
+			return true;
+		}
+	} handler;
+
+	struct EventHandlerAfter  {
+		int64_t accumulated = 0;
+		bool event ( int64_t seq, my_event& event ) {
+			accumulated += event._final;
+			return true;
+		}
+	} after_handler1, after_handler2;
+
+	{
+		isdl::disruptor< my_event, int64_t, isdl::yielding_wait_strategy, isdl::single_producer > testdisruptor ( 1024 );
+
+		testdisruptor.first ( handler ).then ( after_handler1, after_handler2 ); 
+		testdisruptor.start();
+
+		int64_t seq = testdisruptor.next ( 2 );
+		ASSERT_EQUAL ( seq, 0, "Make sure that the first sequence number is 0" );
+		ASSERT_EQUAL ( testdisruptor.allocated(), 2, "Allocated size is 2" );
+		testdisruptor[seq]._value = 1;
+		testdisruptor[seq+1]._value = 2;
+		testdisruptor.publish ( seq, 2 );
+
+		for ( int64_t i = 3; i < 10000001; ++i ) {
+			int64_t seq = testdisruptor.next();
+			testdisruptor[seq]._value = i;
+			testdisruptor.publish ( seq ); 
+		}
+	}
+	ASSERT_EQUAL( after_handler1.accumulated, (10000001L*5000000L), "Check accumulated count of after handler 1" );
+	ASSERT_EQUAL( after_handler2.accumulated, (10000001L*5000000L), "Check accumulated count of after handler 2" );
+}
+
+TEST ( "Test single producer", disruptor9 );
+
+/**
+ * Handler receiving end of batch flag and batch notifications
+ */
+void disruptor10 () {
+	struct EventHandler {
+		int64_t accumulated = 0;
+		int64_t batch_events = 0;
+		int64_t batch_start = 0;
+		int64_t end_of_batch = 0;
+		int64_t batches = 0;
+		int64_t invalid_batches = 0;
+		void on_batch_start ( int64_t seq, size_t count ) {
+			batch_start = seq;
+			batch_events = 0;
+		}
+		bool event ( int64_t seq, int64_t& value, bool end ) {
+			accumulated += value;
+			++batch_events;
+			if ( end ) ++end_of_batch;
+			return true;
+		}
+		void on_batch_end ( int64_t seq, size_t count ) {
+			if ( seq != batch_start || batch_events != count ) ++invalid_batches;
+			++batches;
+		}
+	} handler, tombstone_handler;
+
+	struct EventHandlerAfter {
+		int64_t accumulated = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			accumulated += value;
+			return true;
+		}
+	} after_handler;
+
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 1024 );
+		testdisruptor.first ( handler ).then ( after_handler );
+		testdisruptor.start();
+
+		for ( int64_t i = 1; i < 1000001; ++i ) {
+			int64_t seq = testdisruptor.next();
+			testdisruptor[seq]=i;
+			testdisruptor.publish ( seq ); 
+		}
+	}
+	ASSERT_EQUAL( handler.accumulated, (1000001L*500000L), "Check accumulated value for the batch handler" );
+	ASSERT_EQUAL( after_handler.accumulated, (1000001L*500000L), "Check accumulated value for the after handler" );
+	ASSERT_EQUAL( handler.end_of_batch, handler.batches, "Every batch has one end of batch event" );
+	ASSERT_EQUAL( handler.invalid_batches, 0, "Batch notifications match the events received" );
+
+	/// The batch ends with the tombstones of an abandoned claim
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 16 );
+		testdisruptor.first ( tombstone_handler );
+		testdisruptor.start();
+		testdisruptor.pause ();
+		{
+			auto range = testdisruptor.claim ( 2 );
+			range[0] = 1;
+			range[1] = 2;
+			range.commit ();
+		}
+		{
+			auto range = testdisruptor.claim ( 1 );
+		}
+		testdisruptor.resume ();
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::seconds ( 10 ) ), true, "Events are processed when resumed" );
+	}
+	ASSERT_EQUAL( tombstone_handler.accumulated, 3, "Tombstones are not passed to the handler" );
+	ASSERT_EQUAL( tombstone_handler.end_of_batch, tombstone_handler.batches, 
+		"Batch ending with tombstones has an end of batch event" );
+}
+
+TEST ( "Test end of batch notifications", disruptor10 );
+
+/**
+ * Publishing claimed ranges, tombstones and batches
+ */
+void disruptor11 () {
+	struct EventHandler {
+		int64_t accumulated = 0;
+		int64_t events = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			accumulated += value;
+			++events;
+			return true;
+		}
+	} handler;
+
+	struct EventHandlerAfter {
+		int64_t events = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			++events;
+			return true;
+		}
+	} after_handler;
+
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 16 );
+		testdisruptor.first ( handler ).then ( after_handler );
+		testdisruptor.start();
+
+		{
+			auto range = testdisruptor.claim ( 4 );
+			ASSERT_EQUAL ( range.sequence (), 0, "First claimed sequence is 0" );
+			ASSERT_EQUAL ( range.size (), 4, "Four events claimed" );
+			int64_t value = 1;
+			for ( int64_t& event : range ) {
+				event = value++;
+			}
+			range.commit ();
+		}
+
+		/// Exception thrown while filling the events publishes tombstones
+		try {
+			auto range = testdisruptor.claim ( 3 );
+			range[0] = 1000;
+			throw isdl::invalid_operation ( "Failed to fill the events" );
+		} catch ( isdl::invalid_operation& ) {
+		}
+
+		std::vector < int64_t > values { 5, 6, 7, 8, 9, 10 };
+		/// Larger than the buffer so the tombstones need to be released by the handlers
+		for ( int i = 0; i < 10; ++i ) {
+			int64_t seq = testdisruptor.publish_batch ( values.begin(), values.end(), 
+				[] ( int64_t& event, int64_t value ) { event = value; } );
+			ASSERT_EQUAL ( seq, 7 + i * 6, "Batch is published after the tombstones" );
+		}
+	}
+	ASSERT_EQUAL( handler.accumulated, 10 + 450, "Tombstones are not passed to the handler" );
+	ASSERT_EQUAL( handler.events, 64, "Tombstones are not counted as events" );
+	ASSERT_EQUAL( after_handler.events, 64, "Tombstones are not passed to the after handler" );
+}
+
+TEST ( "Test claim ranges and batch publishing", disruptor11 );
+
+/**
+ * Diamond dependencies, journal and replicate in parallel, business logic after both and 
+ * metrics after journal only
+ */
+void disruptor12 () {
+	struct my_event {
+		int64_t _value;
+		int64_t _journal;
+		int64_t _replicate;
+	};
+
+	struct JournalHandler {
+		bool event ( int64_t seq, my_event& event ) {
+			event._journal = event._value;
+			return true;
+		}
+	} journal;
+
+	struct ReplicateHandler {
+		bool event ( int64_t seq, my_event& event ) {
+			event._replicate = event._value;
+			return true;
+		}
+	} replicate;
+
+	struct BusinessHandler {
+		int64_t accumulated = 0;
+		bool event ( int64_t seq, my_event& event ) {
+			accumulated += event._journal + event._replicate;
+			return true;
+		}
+	} business;
+
+	struct MetricsHandler {
+		int64_t accumulated = 0;
+		bool event ( int64_t seq, my_event& event ) {
+			accumulated += event._journal;
+			return true;
+		}
+	} metrics;
+
+	{
+		isdl::disruptor< my_event, int64_t, isdl::yielding_wait_strategy, isdl::single_producer > testdisruptor ( 1024 );
+
+		testdisruptor.first ( journal, replicate );
+		testdisruptor.after ( journal, replicate ).then ( business );
+		testdisruptor.after ( journal ).then ( metrics );
+		testdisruptor.start();
+
+		for ( int64_t i = 1; i < 1000001; ++i ) {
+			int64_t seq = testdisruptor.next();
+			testdisruptor[seq]._value = i;
+			testdisruptor.publish ( seq ); 
+		}
+	}
+	ASSERT_EQUAL( business.accumulated, 2*(1000001L*500000L), "Business handler sees journal and replicate results" );
+	ASSERT_EQUAL( metrics.accumulated, (1000001L*500000L), "Metrics handler sees journal results" );
+
+	struct EventHandler {
+		bool event ( int64_t seq, my_event& event ) {
+			return true;
+		}
+	} handler1, handler2, handler3;
+
+	{
+		isdl::disruptor< my_event, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 1024 );
+		testdisruptor.first ( handler1 );
+		testdisruptor.after ( handler1, handler3 ).then ( handler2 );
+		testdisruptor.after ( handler2 ).then ( handler3 );
+		bool cycle = false;
+		try {
+			testdisruptor.start ();
+		} catch ( isdl::invalid_operation& ) {
+			cycle = true;
+		}
+		ASSERT_EQUAL( cycle, true, "Cycle in the dependencies is detected" );
+	}
+}
+
+TEST ( "Test handler dependencies", disruptor12 );
+
+/**
+ * Worker pool, every event is processed by exactly one worker
+ */
+void disruptor13 () {
+	struct Worker {
+		int64_t accumulated = 0;
+		int64_t events = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			accumulated += value;
+			++events;
+			return true;
+		}
+	} worker1, worker2, worker3, worker4;
+
+	struct EventHandlerAfter {
+		int64_t accumulated = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			accumulated += value;
+			return true;
+		}
+	} after_handler;
+
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy > testdisruptor ( 1024 );
+		testdisruptor.workers ( worker1, worker2, worker3, worker4 ).then ( after_handler );
+		testdisruptor.start();
+
+		for ( int64_t i = 1; i < 1000001; ++i ) {
+			int64_t seq = testdisruptor.next();
+			testdisruptor[seq]=i;
+			testdisruptor.publish ( seq ); 
+		}
+	}
+	ASSERT_EQUAL( worker1.accumulated + worker2.accumulated + worker3.accumulated + worker4.accumulated, 
+		(1000001L*500000L), "Check accumulated value of the workers" );
+	ASSERT_EQUAL( worker1.events + worker2.events + worker3.events + worker4.events, 1000000,
+		"Every event is processed once" );
+	ASSERT_EQUAL( after_handler.accumulated, (1000001L*500000L), "Check accumulated value of the after handler" );
+}
+
+TEST ( "Test worker pool", disruptor13 );
+
+/**
+ * Ring buffer memory placed with huge pages, locked and prefaulted
+ */
+void disruptor14 () {
+	struct EventHandler {
+		int64_t accumulated = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			accumulated += value;
+			return true;
+		}
+	} handler1, handler2;
+
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 65536 );
+		testdisruptor.first ( handler1, handler2 );
+		testdisruptor.start ( isdl::memory_policy ().huge_pages ().lock ().prefault () );
+
+		for ( int64_t i = 1; i < 1000001; ++i ) {
+			int64_t seq = testdisruptor.next();
+			testdisruptor[seq]=i;
+			testdisruptor.publish ( seq ); 
+		}
+	}
+	ASSERT_EQUAL( handler1.accumulated, (1000001L*500000L), "Check accumulated value of the first handler" );
+	ASSERT_EQUAL( handler2.accumulated, (1000001L*500000L), "Check accumulated value of the second handler" );
+
+	isdl::ring_memory memory ( 4096, isdl::memory_policy ().numa_node ( 0 ).prefault () );
+	ASSERT_EQUAL( ( memory.get () != nullptr ), true, "Memory bound to the first NUMA node is mapped" );
+}
+
+TEST ( "Test ring buffer memory policy", disruptor14 );
+
+/**
+ * Handler threads started by the thread factory, named and pinned to the first CPU
+ */
+void disruptor15 () {
+	struct EventHandler {
+		int64_t accumulated = 0;
+		std::string name;
+		int cpus = 0;
+		bool pinned = false;
+		bool event ( int64_t seq, int64_t& value ) {
+			if ( seq == 0 ) {
+				char thread_name[16];
+				pthread_getname_np ( pthread_self (), thread_name, sizeof ( thread_name ) );
+				name = thread_name;
+				cpu_set_t set;
+				pthread_getaffinity_np ( pthread_self (), sizeof ( set ), &set );
+				cpus = CPU_COUNT ( &set );
+				pinned = CPU_ISSET ( 0, &set );
+			}
+			accumulated += value;
+			return true;
+		}
+	} handler1, handler2, restarted;
+
+	int started = 0;
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 1024, 
+			[&started] ( std::function < void () > task ) { ++started; return std::thread ( task ); } );
+		testdisruptor.first ( handler1 ).then ( handler2 );
+		testdisruptor.configure ( handler1, isdl::thread_options ().name ( "journal-handler-thread" ).cpu ( 0 ) );
+		testdisruptor.start();
+
+		for ( int64_t i = 1; i < 100001; ++i ) {
+			int64_t seq = testdisruptor.next();
+			testdisruptor[seq]=i;
+			testdisruptor.publish ( seq ); 
+		}
+	}
+	ASSERT_EQUAL( started, 2, "Handler threads are started by the thread factory" );
+	ASSERT_EQUAL( handler1.name, std::string ( "journal-handler" ), "Handler thread name is truncated to 15 characters" );
+	ASSERT_EQUAL( handler1.cpus, 1, "Handler thread runs on a single CPU" );
+	ASSERT_EQUAL( handler1.pinned, true, "Handler thread is pinned to the first CPU" );
+	ASSERT_EQUAL( handler2.accumulated, (100001L*50000L), "Check accumulated value of the second handler" );
+
+	/// The options are applied to the restarted threads before they process the events
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 1024 );
+		testdisruptor.first ( restarted );
+		testdisruptor.configure ( restarted, isdl::thread_options ().name ( "restarted" ).cpu ( 0 ) );
+		testdisruptor.start();
+		testdisruptor.halt ();
+		for ( int64_t i = 1; i < 9; ++i ) {
+			int64_t seq = testdisruptor.next();
+			testdisruptor[seq]=i;
+			testdisruptor.publish ( seq ); 
+		}
+		testdisruptor.restart ();
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::seconds ( 10 ) ), true, "Restarted handler processes the events" );
+	}
+	ASSERT_EQUAL( restarted.name, std::string ( "restarted" ), "Restarted handler thread is named before processing" );
+	ASSERT_EQUAL( restarted.pinned, true, "Restarted handler thread is pinned before processing" );
+
+	struct EventHandlerNotAdded {
+		bool event ( int64_t seq, int64_t& value ) {
+			return true;
+		}
+	} not_added;
+
+	bool failed = false;
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 1024 );
+		testdisruptor.first ( handler1 );
+		testdisruptor.configure ( not_added, isdl::thread_options ().cpu ( 0 ) );
+		try {
+			testdisruptor.start ();
+		} catch ( isdl::invalid_operation& ) {
+			failed = true;
+		}
+	}
+	ASSERT_EQUAL( failed, true, "Configuring a handler which is not added fails" );
+}
+
+TEST ( "Test handler thread options", disruptor15 );
+
+/**
+ * Metrics snapshot of the sequences, the lag and the handler counters
+ */
+void disruptor16 () {
+	struct EventHandler {
+		std::atomic < int64_t > processed { 0 };
+		bool event ( int64_t seq, int64_t& value ) {
+			processed.store ( seq + 1 );
+			return true;
+		}
+	} handler1, handler2;
+
+	isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 1024 );
+	testdisruptor.first ( handler1 ).then ( handler2 );
+
+	auto before = testdisruptor.metrics ();
+	ASSERT_EQUAL( before._started, false, "Snapshot can be taken before the disruptor is started" );
+	ASSERT_EQUAL( before._handlers.size (), 2, "Snapshot reports every handler" );
+
+	testdisruptor.start();
+	for ( int64_t i = 0; i < 100000; ++i ) {
+		int64_t seq = testdisruptor.next();
+		testdisruptor[seq] = i;
+		testdisruptor.publish ( seq ); 
+	}
+	while ( handler2.processed.load () != 100000 ) {
+		std::this_thread::yield ();
+	}
+	/// The sequence is released after the handler returns from the last event
+	auto after = testdisruptor.metrics ();
+	while ( after._handlers[1]._sequence != 100000 ) {
+		std::this_thread::yield ();
+		after = testdisruptor.metrics ();
+	}
+	ASSERT_EQUAL( after._started, true, "Snapshot reports the disruptor is started" );
+	ASSERT_EQUAL( after._cursor, 100000, "Cursor follows the last claimed event" );
+	ASSERT_EQUAL( after._depth, 0, "All the claimed events are released" );
+	ASSERT_EQUAL( after._handlers[0]._lag, 0, "First handler processed all the events" );
+	ASSERT_EQUAL( after._handlers[1]._lag, 0, "Second handler processed all the events" );
+	if ( after._enabled ) {
+		ASSERT_EQUAL( after._handlers[1]._events, 100000, "Handler counts the processed events" );
+		uint64_t batches = 0;
+		for ( uint64_t count : after._handlers[1]._batch_sizes ) {
+			batches += count;
+		}
+		ASSERT_EQUAL( batches, after._handlers[1]._batches, "Every batch is counted in the batch size histogram" );
+	}
+}
+
+TEST ( "Test disruptor metrics", disruptor16 );
+
+/**
+ * Allocating without waiting and with a timeout when the handlers don't free the slots
+ */
+void disruptor17 () {
+	struct EventHandler {
+		std::atomic < bool > blocked { true };
+		int64_t events = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			while ( blocked.load () ) {
+				std::this_thread::yield ();
+			}
+			++events;
+			return true;
+		}
+	} handler;
+
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy > testdisruptor ( 16 );
+		testdisruptor.first ( handler );
+		testdisruptor.start();
+
+		auto first = testdisruptor.try_next ( 16 );
+		ASSERT_EQUAL( first.has_value (), true, "Free slots are allocated without waiting" );
+		testdisruptor.publish ( *first, 16 );
+
+		ASSERT_EQUAL( testdisruptor.try_next ().has_value (), false, "Full buffer is reported without waiting" );
+		ASSERT_EQUAL( testdisruptor.try_claim ( 1 ).has_value (), false, "Full buffer can not be claimed" );
+
+		auto start_time = std::chrono::steady_clock::now ();
+		auto timed_out = testdisruptor.next_for ( 1, std::chrono::milliseconds ( 20 ) );
+		ASSERT_EQUAL( timed_out.has_value (), false, "Allocation times out when the buffer stays full" );
+		ASSERT_EQUAL( ( std::chrono::steady_clock::now () - start_time >= std::chrono::milliseconds ( 20 ) ), true,
+			"Allocation waits for the timeout" );
+
+		handler.blocked.store ( false );
+		auto range = testdisruptor.claim_for ( 4, std::chrono::seconds ( 10 ) );
+		ASSERT_EQUAL( range.has_value (), true, "Allocation succeeds when the handler frees the slots" );
+		for ( int64_t& event : *range ) {
+			event = 1;
+		}
+		range->commit ();
+	}
+	ASSERT_EQUAL( handler.events, 20, "Handler receives all the published events" );
+}
+
+TEST ( "Test allocation without waiting", disruptor17 );
+
+
+/**
+ * Large batches wrapping around the end of the ring are published and counted as a whole
+ */
+void disruptor18 () {
+	struct EventHandler {
+		int64_t accumulated = 0;
+		int64_t events = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			accumulated += value;
+			++events;
+			return true;
+		}
+	} handler;
+
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy > testdisruptor ( 512 );
+		testdisruptor.first ( handler );
+		testdisruptor.start();
+
+		std::vector < std::thread > producers;
+		for ( int producer = 0; producer < 2; ++producer ) {
+			producers.push_back ( std::thread ( [&testdisruptor] {
+				for ( int batch = 0; batch < 100; ++batch ) {
+					auto range = testdisruptor.claim ( 300 );
+					int64_t value = 1;
+					for ( int64_t& event : range ) {
+						event = value++;
+					}
+					range.commit ();
+				}
+			} ) );
+		}
+		for ( std::thread& producer : producers ) {
+			producer.join ();
+		}
+	}
+	ASSERT_EQUAL( handler.events, 60000, "Handler receives all the events of the batches" );
+	ASSERT_EQUAL( handler.accumulated, 200 * 300 * 301 / 2, "Handler receives the values of the batches" );
+}
+
+TEST ( "Test publishing large batches", disruptor18 );
+
+
+/**
+ * Pausing, draining, halting and restarting the handlers
+ */
+void disruptor19 () {
+	struct EventHandler {
+		std::atomic < int64_t > events { 0 };
+		bool event ( int64_t seq, int64_t& value ) {
+			++events;
+			return true;
+		}
+	} handler, after_handler;
+
+	auto publish = [] ( isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy >& testdisruptor, 
+		size_t events ) {
+		for ( size_t event = 0; event < events; ++event ) {
+			int64_t seq = testdisruptor.next ();
+			testdisruptor[seq] = event;
+			testdisruptor.publish ( seq );
+		}
+	};
+
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy > testdisruptor ( 16 );
+		testdisruptor.first ( handler ).then ( after_handler );
+		testdisruptor.start();
+
+		testdisruptor.pause ( after_handler );
+		publish ( testdisruptor, 16 );
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::milliseconds ( 20 ) ), false, 
+			"Paused handler doesn't drain the buffer" );
+		ASSERT_EQUAL( handler.events.load (), 16, "Handler before the paused group processes the events" );
+		ASSERT_EQUAL( after_handler.events.load (), 0, "Paused handler doesn't process the events" );
+		ASSERT_EQUAL( testdisruptor.try_next ().has_value (), false, "Paused handler holds the slots" );
+
+		testdisruptor.resume ();
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::seconds ( 10 ) ), true, "Resumed handlers drain the buffer" );
+		ASSERT_EQUAL( after_handler.events.load (), 16, "Resumed handler processes the events" );
+
+		testdisruptor.halt ();
+		publish ( testdisruptor, 8 );
+		std::this_thread::sleep_for ( std::chrono::milliseconds ( 10 ) );
+		ASSERT_EQUAL( handler.events.load (), 16, "Halted handler doesn't process the events" );
+
+		testdisruptor.restart ();
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::seconds ( 10 ) ), true, "Restarted handlers drain the buffer" );
+		ASSERT_EQUAL( handler.events.load (), 24, "Restarted handler continues after the processed events" );
+		ASSERT_EQUAL( after_handler.events.load (), 24, "Restarted downstream handler continues after the processed events" );
+
+		/// Destroyed with the buffer full
+		testdisruptor.pause ();
+		publish ( testdisruptor, 16 );
+	}
+	ASSERT_EQUAL( handler.events.load (), 40, "Events in the full buffer are processed when destroyed" );
+	ASSERT_EQUAL( after_handler.events.load (), 40, "Downstream handler processes the events when destroyed" );
+}
+
+TEST ( "Test pause, drain, halt and restart", disruptor19 );
+
+
+/**
+ * Handling exceptions thrown by the handlers
+ */
+void disruptor20 () {
+	struct FailingHandler {
+		std::atomic < int64_t > events { 0 };
+		std::atomic < int64_t > failures { 0 };
+		/// Number of times the event with value 0 fails before it is processed
+		int64_t failing = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			if ( value < 0 ) {
+				++failures;
+				throw isdl::invalid_parameter ( "Malformed event" );
+			}
+			if ( value == 0 && failing > 0 ) {
+				--failing;
+				++failures;
+				throw isdl::invalid_parameter ( "Temporary failure" );
+			}
+			++events;
+			return true;
+		}
+	};
+
+	struct EventHandler {
+		std::atomic < int64_t > events { 0 };
+		bool event ( int64_t seq, int64_t& value ) {
+			++events;
+			return true;
+		}
+	};
+
+	auto publish = [] ( isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy >& testdisruptor, 
+		std::vector < int64_t > values ) {
+		testdisruptor.publish_batch ( values.begin (), values.end (), [] ( int64_t& event, int64_t value ) { 
+			event = value; } );
+	};
+
+	/// Failed events are skipped and reported, the downstream handler receives them
+	FailingHandler skipping;
+	EventHandler after_skipping;
+	std::vector < int64_t > reported;
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy > testdisruptor ( 16 );
+		testdisruptor.first ( skipping ).then ( after_skipping );
+		testdisruptor.on_fault ( skipping, isdl::skip_on_fault < int64_t > ( 
+			[&reported] ( int64_t seq, std::exception_ptr error ) { reported.push_back ( seq ); } ) );
+		testdisruptor.start ();
+		for ( int i = 0; i < 10; ++i ) {
+			publish ( testdisruptor, { 1, -1, 2 } );
+		}
+	}
+	ASSERT_EQUAL( skipping.events.load (), 20, "Valid events are processed" );
+	ASSERT_EQUAL( skipping.failures.load (), 10, "Malformed events fail" );
+	ASSERT_EQUAL( reported.size (), 10, "Skipped events are reported" );
+	ASSERT_EQUAL( reported[0], 1, "Sequence of the skipped event is reported" );
+	ASSERT_EQUAL( after_skipping.events.load (), 30, "Downstream handler receives the skipped events" );
+
+	/// Failed events are retried and skipped when the retries fail
+	FailingHandler retrying;
+	retrying.failing = 2;
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy > testdisruptor ( 16 );
+		testdisruptor.first ( retrying );
+		testdisruptor.on_fault ( retrying, isdl::retry_on_fault < int64_t > ( 3 ) );
+		testdisruptor.start ();
+		publish ( testdisruptor, { 0, -1, 1 } );
+	}
+	ASSERT_EQUAL( retrying.events.load (), 2, "Retried event is processed" );
+	ASSERT_EQUAL( retrying.failures.load (), 2 + 4, "Events are retried the configured number of times" );
+
+	/// Failed event pauses the group until resumed
+	FailingHandler halting;
+	halting.failing = 1;
+	EventHandler after_halting;
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy > testdisruptor ( 16 );
+		testdisruptor.first ( halting ).then ( after_halting );
+		testdisruptor.on_fault ( halting, isdl::halt_on_fault < int64_t > () );
+		testdisruptor.start ();
+		publish ( testdisruptor, { 1, 0, 2 } );
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::milliseconds ( 20 ) ), false, 
+			"Halted group doesn't process the events" );
+		ASSERT_EQUAL( halting.events.load (), 1, "Events before the failed event are processed" );
+		testdisruptor.resume ();
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::seconds ( 10 ) ), true, "Resumed group processes the events" );
+	}
+	ASSERT_EQUAL( halting.events.load (), 3, "Failed event is processed when resumed" );
+	ASSERT_EQUAL( after_halting.events.load (), 3, "Downstream handler receives the events" );
+
+	/// Failed event is kept when the disruptor is halted while the group is paused
+	FailingHandler restarted;
+	restarted.failing = 1;
+	EventHandler after_restarted;
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy > testdisruptor ( 16 );
+		testdisruptor.first ( restarted ).then ( after_restarted );
+		testdisruptor.on_fault ( restarted, isdl::halt_on_fault < int64_t > () );
+		testdisruptor.start ();
+		publish ( testdisruptor, { 1, 0, 2 } );
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::milliseconds ( 20 ) ), false, 
+			"Halted group doesn't process the events before restart" );
+		testdisruptor.halt ();
+		ASSERT_EQUAL( restarted.events.load (), 1, "Events after the failed event are not processed when halted" );
+		testdisruptor.restart ();
+		testdisruptor.resume ();
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::seconds ( 10 ) ), true, "Restarted group processes the events" );
+	}
+	ASSERT_EQUAL( restarted.events.load (), 3, "Failed event is processed after restart" );
+	ASSERT_EQUAL( after_restarted.events.load (), 3, "Downstream handler receives the events after restart" );
+
+	/// Event claimed by a worker is kept when the disruptor is halted while the pool is paused
+	FailingHandler worker1, worker2;
+	worker1.failing = 1;
+	worker2.failing = 1;
+	EventHandler after_workers;
+	{
+		isdl::disruptor< int64_t, int64_t, isdl::blocking_wait_strategy > testdisruptor ( 16 );
+		testdisruptor.workers ( worker1, worker2 ).then ( after_workers );
+		testdisruptor.on_fault ( worker1, isdl::halt_on_fault < int64_t > () );
+		testdisruptor.on_fault ( worker2, isdl::halt_on_fault < int64_t > () );
+		testdisruptor.start ();
+		publish ( testdisruptor, { 1, 0, 2 } );
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::milliseconds ( 20 ) ), false, 
+			"Halted pool doesn't pass the failed event downstream" );
+		testdisruptor.halt ();
+		testdisruptor.restart ();
+		testdisruptor.resume ();
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::seconds ( 10 ) ), true, "Restarted pool processes the events" );
+	}
+	ASSERT_EQUAL( worker1.events.load () + worker2.events.load (), 3, "Failed event is processed by the restarted worker" );
+	ASSERT_EQUAL( after_workers.events.load (), 3, "Downstream handler receives the events of the restarted pool" );
+}
+
+TEST ( "Test handler exceptions", disruptor20 );
+
+
+/**
+ * Producers claiming with fetch and add and reserving blocks of sequences
+ */
+void disruptor21 () {
+	struct EventHandler {
+		int64_t accumulated = 0;
+		int64_t events = 0;
+		bool event ( int64_t seq, int64_t& value ) {
+			accumulated += value;
+			++events;
+			return true;
+		}
+	} handler, batched_handler;
+
+	using fetch_add_disruptor = isdl::disruptor< int64_t, int64_t, isdl::yielding_wait_strategy, 
+		isdl::fetch_add_producer >;
+	{
+		fetch_add_disruptor testdisruptor ( 64 );
+		testdisruptor.first ( handler );
+		testdisruptor.start();
+
+		std::vector < std::thread > producers;
+		for ( int producer = 0; producer < 8; ++producer ) {
+			producers.push_back ( std::thread ( [&testdisruptor] {
+				for ( int64_t value = 1; value <= 1000; ++value ) {
+					int64_t seq = testdisruptor.next ();
+					testdisruptor[seq] = value;
+					testdisruptor.publish ( seq );
+				}
+			} ) );
+		}
+		for ( std::thread& producer : producers ) {
+			producer.join ();
+		}
+	}
+	ASSERT_EQUAL( handler.events, 8000, "Handler receives the events claimed with fetch and add" );
+	ASSERT_EQUAL( handler.accumulated, 8 * 1000 * 1001 / 2, "Handler receives the values claimed with fetch and add" );
+
+	{
+		fetch_add_disruptor testdisruptor ( 64 );
+		testdisruptor.first ( batched_handler );
+		testdisruptor.start();
+
+		std::vector < std::thread > producers;
+		for ( int producer = 0; producer < 4; ++producer ) {
+			producers.push_back ( std::thread ( [&testdisruptor] {
+				isdl::batched_producer < int64_t, int64_t, isdl::yielding_wait_strategy, 
+					isdl::fetch_add_producer > batched ( testdisruptor, 8 );
+				/// Not a multiple of the block, the last block is flushed with tombstones
+				for ( int64_t value = 1; value <= 1001; ++value ) {
+					int64_t seq = batched.next ();
+					batched[seq] = value;
+					batched.publish ( seq );
+				}
+			} ) );
+		}
+		for ( std::thread& producer : producers ) {
+			producer.join ();
+		}
+		ASSERT_EQUAL( testdisruptor.drain ( std::chrono::seconds ( 10 ) ), true, "Flushed blocks are drained" );
+	}
+	ASSERT_EQUAL( batched_handler.events, 4004, "Handler receives the events of the reserved blocks" );
+	ASSERT_EQUAL( batched_handler.accumulated, 4 * 1001 * 1002 / 2, "Handler receives the values of the reserved blocks" );
+}
+
+TEST ( "Test fetch and add producers", disruptor21 );
+
+
+/**
+ * Fills and scans runs of availability flags with lengths that are not a multiple of the vector
+ * width, the first mismatch is placed at every position of the run
+ */
+template < typename Flag > void check_availability_flags () {
+	constexpr size_t max_count = 37;
+	Flag flags[max_count + 1];
+	for ( size_t count = 0; count <= max_count; ++count ) {
+		flags[count] = 5;
+		isdl::_fill_flags ( flags, count, Flag ( 7 ) );
+		size_t filled = 0;
+		for ( ; filled < count && flags[filled] == 7; ++filled );
+		ASSERT_EQUAL( filled, count, "All the flags of the run are stored" );
+		ASSERT_EQUAL( flags[count], Flag ( 5 ), "Flags after the run are not touched" );
+		for ( size_t mismatch = 0; mismatch <= count; ++mismatch ) {
+			isdl::_fill_flags ( flags, count, Flag ( 7 ) );
+			if ( mismatch < count ) flags[mismatch] = 6;
+			ASSERT_EQUAL( isdl::_count_equal ( flags, count, Flag ( 7 ) ), mismatch, "Scan stops at the first different flag" );
+#if defined ( ISDL_AVAILABILITY_AVX2 )
+			if ( isdl::_has_avx2 () ) {
+				ASSERT_EQUAL( isdl::_count_equal_avx2 ( flags, count, Flag ( 7 ) ), mismatch, "AVX2 scan stops at the first different flag" );
+			}
+#endif
+		}
+#if defined ( ISDL_AVAILABILITY_AVX2 )
+		if ( isdl::_has_avx2 () ) {
+			isdl::_fill_flags_avx2 ( flags, count, Flag ( 9 ) );
+			ASSERT_EQUAL( isdl::_count_equal ( flags, count, Flag ( 9 ) ), count, "AVX2 stores all the flags of the run" );
+			ASSERT_EQUAL( flags[count], Flag ( 5 ), "AVX2 doesn't store after the run" );
+		}
+#endif
+	}
+}
+
+void disruptor22 () {
+	check_availability_flags < int64_t > ();
+	check_availability_flags < uint32_t > ();
+}
+
+TEST ( "Test availability flag scans", disruptor22 );
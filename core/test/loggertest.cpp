@@ -3,8 +3,18 @@
  */
 #include <unittest>
 #include <logger>
+#include <filelog>
+#include <fstream>
+#include <sstream>
 #include <iostream>
+#include <iterator>
 #include <cstring>
+#include <cstdio>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
 
 void loggertest1 () {
         ASSERT_EQUAL ( isdl::get_params ("Test string { } hello {{}"), 1, "One parameter folloewed by escaped start" );
@@ -101,6 +111,8 @@ void loggertest3 () {
 	while ( !test_back._completed );
 	ASSERT_EQUAL ( test_back.message(), std::string ( "Test string value4: 5, value2: tst hello1 "  ), 
 		"Check message with two parameters " );
+	/// The log_back is destroyed when returning
+	isdl::log_factory->sync ();
 
 }
 
@@ -116,11 +128,316 @@ void loggertest4 () {
 	
 	while ( !test_back._completed );
 	ASSERT_EQUAL ( test_back.message(), std::string ( "*********----------**********----------1*********----------**********----------2*********----------**********----------3*********----------**********----------4") , "Check if long message is logged correctly" );
+	/// The log_back is destroyed when returning
+	isdl::log_factory->sync ();
 }
 
 
+/**
+ * Test arguments captured by the calling thread and formatted by the background thread
+ */
+void loggertest5 () {
+	test_logback test_back ( 1024 );
+	isdl::log_factory->add_logger ( "testlogger", &test_back, isdl::log_level::info ); 
+	isdl::basic_logger& log = isdl::log_factory->get_logger ( "testlogger" );
+
+	std::string text = "temporary";
+	const char *literal = "literal";
+	test_back._completed = false;
+	LOG ( log, isdl::log_level::warning, "int {} double {} char {} bool {} string {} literal {} level {}",
+		-7, 2.5, 'x', true, text, literal, isdl::log_level::error );
+	text = "changed";
+	while ( !test_back._completed );
+	ASSERT_EQUAL ( test_back.message(), std::string ( "int -7 double 2.5 char x bool 1 string temporary literal literal level ERROR" ),
+		"Check that the captured arguments are formatted" );
+	ASSERT_EQUAL ( test_back._lvl, isdl::log_level::warning, "Check if the log level of the deferred record is recorded" );
+
+	std::string long_text ( 300, 'a' );
+	test_back._completed = false;
+	LOG ( log, isdl::log_level::info, "[{}] {}", long_text, 42 );
+	while ( !test_back._completed );
+	ASSERT_EQUAL ( test_back.message(), "[" + long_text + "] 42", "Check that the long argument is captured whole in one record" );
+
+	test_back._completed = false;
+	LOG ( log, isdl::log_level::info, "{}{}", std::hex, 255 );
+	while ( !test_back._completed );
+	ASSERT_EQUAL ( test_back.message(), std::string ( "ff" ), "Check the stream manipulator" );
+	test_back._completed = false;
+	LOG ( log, isdl::log_level::info, "plain {}", 255 );
+	while ( !test_back._completed );
+	ASSERT_EQUAL ( test_back.message(), std::string ( "plain 255" ), "Check that the manipulator doesn't change the following messages" );
+
+	/// The format and its segments are gone before the background thread takes the record
+	char format[] = "direct {}";
+	test_back._completed = false;
+	log.log ( isdl::log_level::info, __FILE__, __LINE__, isdl::fmt_segments < 1 > ( format ), 7 );
+	std::strcpy ( format, "changed{}" );
+	while ( !test_back._completed );
+	ASSERT_EQUAL ( test_back.message(), std::string ( "direct 7" ), "Check that log formats the message on the calling thread" );
+	/// The log_back is destroyed when returning
+	isdl::log_factory->sync ();
+}
+
+/**
+ * Collects the complete messages of more logging threads
+ */
+struct collecting_logback : public isdl::log_back {
+	std::vector < std::string > _messages;
+	std::string _current;
+
+	virtual void add ( isdl::log_level __v, const char *__f, int __l, isdl::timestamp __t,
+		const char *__m, size_t __s, bool __b, bool __e ) {
+		if ( __b ) {
+			_current.clear ();
+		}
+		_current.append ( __m, __s );
+		if ( __e ) {
+			_messages.push_back ( _current );
+		}
+	}
+};
+
+/**
+ * Test messages logged by more threads, every thread has its own staging buffer so the
+ * messages of a thread stay in order and the long messages are not interleaved
+ */
+void loggertest6 () {
+	collecting_logback test_back;
+	isdl::log_factory->add_logger ( "threadlogger", &test_back, isdl::log_level::info ); 
+	isdl::basic_logger& log = isdl::log_factory->get_logger ( "threadlogger" );
+	const int threads = 4;
+	const int messages = 1000;
+	std::string padding ( 150, '-' );
+	std::vector < std::thread > loggers;
+	for ( int thread = 0; thread < threads; ++thread ) {
+		loggers.push_back ( std::thread ( [&log, &padding, thread] {
+			for ( int message = 0; message < messages; ++message ) {
+				if ( message % 10 ) {
+					LOG ( log, isdl::log_level::info, "{} {}", thread, message );
+				} else {
+					LOG ( log, isdl::log_level::info, "{} {} {}", thread, message, padding );
+				}
+			}
+		} ) );
+	}
+	for ( std::thread& thread : loggers ) {
+		thread.join ();
+	}
+	isdl::log_factory->sync ();
+
+	int next[threads] = { 0 };
+	bool ordered = true;
+	for ( const std::string& text : test_back._messages ) {
+		int thread = 0;
+		int message = 0;
+		char rest[200] = { 0 };
+		std::sscanf ( text.c_str (), "%d %d %199s", &thread, &message, rest );
+		std::string expected_rest = message % 10 ? std::string () : padding;
+		ordered = ordered && thread >= 0 && thread < threads && next[thread] == message && rest == expected_rest;
+		if ( thread >= 0 && thread < threads ) next[thread] = message + 1;
+	}
+	ASSERT_EQUAL ( test_back._messages.size (), size_t ( threads * messages ), "Check that all the messages are logged" );
+	ASSERT_EQUAL ( ordered, true, "Check that the messages of every thread are complete and in order" );
+}
+
+/**
+ * Value without a captured representation, the messages with it are formatted on the calling thread
+ */
+struct streamed_text {
+	std::string _text;
+};
+
+std::ostream& operator << ( std::ostream& str, const streamed_text& value ) {
+	return str << value._text;
+}
+
+/**
+ * Test variable length records wrapping around the staging buffer and records longer than
+ * the longest record
+ */
+void loggertest7 () {
+	collecting_logback test_back;
+	isdl::log_factory->add_logger ( "recordlogger", &test_back, isdl::log_level::info ); 
+	isdl::basic_logger& log = isdl::log_factory->get_logger ( "recordlogger" );
+	const size_t messages = 2000;
+	for ( size_t message = 0; message < messages; ++message ) {
+		std::string text ( ( message * 37 ) % 1500, 'a' + message % 26 );
+		if ( message % 2 ) {
+			LOG ( log, isdl::log_level::info, "{}:{}", message, text );
+		} else {
+			LOG ( log, isdl::log_level::info, "{}:{}", message, streamed_text { text } );
+		}
+	}
+	std::string huge ( 100000, 'h' );
+	LOG ( log, isdl::log_level::info, "{}", huge );
+	LOG ( log, isdl::log_level::info, "{}", streamed_text { huge } );
+	isdl::log_factory->sync ();
+
+	bool complete = true;
+	for ( size_t message = 0; message < messages; ++message ) {
+		std::string text ( ( message * 37 ) % 1500, 'a' + message % 26 );
+		complete = complete && test_back._messages[message] == std::to_string ( message ) + ":" + text;
+	}
+	ASSERT_EQUAL ( complete, true, "Check that the records wrapping around the buffer are complete" );
+	bool truncated = true;
+	for ( size_t message = messages; message < messages + 2; ++message ) {
+		const std::string& text = test_back._messages[message];
+		truncated = truncated && text.size () > 16000 && text.size () < huge.size () && 
+			text == huge.substr ( 0, text.size () );
+	}
+	ASSERT_EQUAL ( truncated, true, "Check that the longest messages are truncated" );
+}
+
+/**
+ *@brief logs the lines to the file and returns the messages of the lines in the log file and
+ * 	the rotated files, oldest first
+ */
+static std::vector < std::string > log_to_file ( const std::string& path, const isdl::file_log_options& options,
+	const char *name, size_t lines, size_t& files, size_t sync_lines = 0 ) {
+	std::string padding ( 40, '-' );
+	{
+		isdl::file_logback file_back ( path, options );
+		isdl::log_factory->add_logger ( name, &file_back, isdl::log_level::info ); 
+		isdl::basic_logger& log = isdl::log_factory->get_logger ( name );
+		for ( size_t line = 0; line < lines; ++line ) {
+			LOG ( log, isdl::log_level::info, "line {} {}", line, padding );
+			/// Every sync ends a batch written by the log_back
+			if ( sync_lines && line % sync_lines == sync_lines - 1 ) {
+				isdl::log_factory->sync ();
+			}
+		}
+		/// The log_back can be destroyed once it received the logged records
+		isdl::log_factory->remove_logger ( name );
+		isdl::log_factory->sync ();
+	}
+	std::vector < std::string > paths;
+	for ( size_t index = 1; ! access ( ( path + "." + std::to_string ( index ) ).c_str (), F_OK ); ++index ) {
+		paths.push_back ( path + "." + std::to_string ( index ) );
+	}
+	paths.push_back ( path );
+	files = paths.size ();
+	/// A line can be split between two files at the rotation
+	std::string content;
+	for ( const std::string& file : paths ) {
+		std::ifstream input ( file );
+		content.append ( std::istreambuf_iterator < char > ( input ), std::istreambuf_iterator < char > () );
+		std::remove ( file.c_str () );
+	}
+	std::istringstream input ( content );
+	std::vector < std::string > messages;
+	for ( std::string text; std::getline ( input, text ); ) {
+		size_t separator = text.find ( " : " );
+		messages.push_back ( separator == std::string::npos ? text : text.substr ( separator + 3 ) );
+	}
+	return messages;
+}
+
+/**
+ *@brief checks that the messages are the logged lines in order
+ */
+static bool logged_lines ( const std::vector < std::string >& messages, size_t lines ) {
+	std::string padding ( 40, '-' );
+	bool ordered = messages.size () == lines;
+	for ( size_t line = 0; ordered && line < lines; ++line ) {
+		ordered = messages[line] == "line " + std::to_string ( line ) + " " + padding;
+	}
+	return ordered;
+}
+
+/**
+ * Test the file log_back with small buffers, rotation and O_DIRECT which falls back to the
+ * buffered writes on the file systems without it
+ */
+void loggertest8 () {
+	std::string path = "/tmp/loggertest8." + std::to_string ( getpid () ) + ".log";
+	const size_t lines = 5000;
+	size_t files = 0;
+
+	isdl::file_log_options rotated;
+	rotated._buffer_size = 4096;
+	rotated._buffers = 4;
+	rotated._rotate_size = 64 * 1024;
+	std::vector < std::string > messages = log_to_file ( path, rotated, "filelogger", lines, files );
+	ASSERT_EQUAL ( logged_lines ( messages, lines ), true, "Check that the lines are written in order" );
+	ASSERT_EQUAL ( ( files > 2 ), true, "Check that the file is rotated" );
+
+	isdl::file_log_options direct;
+	direct._buffer_size = 8192;
+	direct._direct = true;
+	messages = log_to_file ( path, direct, "directlogger", lines, files );
+	ASSERT_EQUAL ( logged_lines ( messages, lines ), true, "Check that the lines are written with O_DIRECT" );
+	ASSERT_EQUAL ( files, size_t ( 1 ), "Check that the file is not rotated" );
+
+	direct._rotate_size = 16 * 1024;
+	messages = log_to_file ( path, direct, "directlogger", 1000, files, 7 );
+	ASSERT_EQUAL ( logged_lines ( messages, 1000 ), true, "Check that the lines written at the end of the batches are not repeated" );
+	ASSERT_EQUAL ( ( files > 2 ), true, "Check that the file is rotated with O_DIRECT" );
+
+	/// A few records are in the file when the batch ends, before a whole block is filled
+	{
+		isdl::file_logback file_back ( path, direct );
+		isdl::log_factory->add_logger ( "directlogger", &file_back, isdl::log_level::info );
+		isdl::basic_logger& log = isdl::log_factory->get_logger ( "directlogger" );
+		LOG ( log, isdl::log_level::info, "line {} {}", 0, std::string ( 40, '-' ) );
+		isdl::log_factory->sync ();
+		file_back.sync ();
+		std::ifstream input ( path );
+		std::string text;
+		std::getline ( input, text );
+		size_t separator = text.find ( " : " );
+		std::string message = separator == std::string::npos ? text : text.substr ( separator + 3 );
+		ASSERT_EQUAL ( message, "line 0 " + std::string ( 40, '-' ),
+			"Check that the line is written before the block is full" );
+		isdl::log_factory->remove_logger ( "directlogger" );
+		isdl::log_factory->sync ();
+	}
+	std::remove ( path.c_str () );
+}
+
+/**
+ * Test the timestamps converted by the background thread, they are taken from the time stamp
+ * counter if compiled with ISDL_LOG_TSC_TIMESTAMP
+ */
+void loggertest9 () {
+	test_logback test_back ( 1024 );
+	isdl::log_factory->add_logger ( "timelogger", &test_back, isdl::log_level::info ); 
+	isdl::basic_logger& log = isdl::log_factory->get_logger ( "timelogger" );
+	bool within = true;
+	bool ordered = true;
+	isdl::timestamp previous;
+	for ( int message = 0; message < 20; ++message ) {
+		isdl::timestamp before = std::chrono::system_clock::now ();
+		test_back._completed = false;
+		LOG ( log, isdl::log_level::info, "Time {}", message );
+		while ( !test_back._completed );
+		isdl::timestamp after = std::chrono::system_clock::now ();
+		/// The conversion of the counter may be off by the error of the calibration
+		within = within && test_back._timestamp > before - std::chrono::milliseconds ( 5 ) &&
+			test_back._timestamp < after + std::chrono::milliseconds ( 5 );
+		ordered = ordered && ( ! message || previous <= test_back._timestamp );
+		previous = test_back._timestamp;
+		std::this_thread::sleep_for ( std::chrono::milliseconds ( 1 ) );
+	}
+	/// The log_back is destroyed when returning
+	isdl::log_factory->sync ();
+	ASSERT_EQUAL ( within, true, "Check that the timestamps are taken when the messages are logged" );
+	ASSERT_EQUAL ( ordered, true, "Check that the timestamps grow" );
+
+	isdl::log_time_format time_format;
+	isdl::timestamp time = isdl::timestamp ( std::chrono::seconds ( 86400 * 365 ) + std::chrono::milliseconds ( 7 ) );
+	std::string text ( time_format.format ( time ) );
+	ASSERT_EQUAL ( text.substr ( text.size () - 5 ), std::string ( ".007 " ), "Check the formatted milliseconds" );
+	text = time_format.format ( time + std::chrono::milliseconds ( 250 ) );
+	ASSERT_EQUAL ( text.substr ( text.size () - 5 ), std::string ( ".257 " ), "Check the milliseconds formatted with the cached second" );
+}
+
 
 TEST ( " Test constexpr correctly identifys parameters placeholders", loggertest1 )
 TEST ( " Test constexpr parses log messages segments correctly", loggertest2 )
 TEST ( " Test information recorded by the logger", loggertest3 )
 TEST ( " Test message longer than queue element size", loggertest4 )
+TEST ( " Test arguments formatted by the background thread", loggertest5 )
+TEST ( " Test messages logged by more threads", loggertest6 )
+TEST ( " Test variable length log records", loggertest7 )
+TEST ( " Test file log_back", loggertest8 )
+TEST ( " Test timestamps of the log records", loggertest9 )
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <thread>
 #include <memory>
+#include <string>
 
 
 
@@ -252,3 +253,204 @@ void test8 () {
 
 TEST ( "Power of two calculation test", test8 )
 
+
+/**
+ * Multiple producers multiple consumers test with the queue data mapped on huge pages
+ */
+void test9 () {
+	isdl::ringqueue < int, int64_t, 1048576, 3 > queue ( isdl::memory_policy ().huge_pages ().prefault () );
+	int64_t acumulator = 0;
+	int64_t acumulator1 = 0;
+	int64_t acumulator2 = 0;
+	std::thread receiver1 ( Receiver<1048576, 3> ( acumulator, queue, 3, 0 ) );
+	std::thread receiver2 ( Receiver<1048576, 3> ( acumulator1, queue, 3, 1 ) );
+	std::thread receiver3 ( Receiver<1048576, 3> ( acumulator2, queue, 3, 2 ) );
+	std::thread publisher1 ( Publisher<1048576, 3> ( 1, 10000001, 2, queue) );
+	std::thread publisher2 ( Publisher<1048576, 3> ( 2, 10000001, 2, queue) );
+	publisher1.join();
+	publisher2.join();
+	int64_t index = queue.allocate(3);
+	for ( int i = 0; i< 3; ++i ) {
+		queue [ index+i ] = -1;
+	}
+	queue.commit( index, 3);
+	receiver1.join();
+	receiver2.join();
+	receiver3.join();
+	ASSERT_EQUAL ( acumulator+acumulator1+acumulator2, 10000001L*(10000000L/2), "Make sure acumulated value is correct" );
+}
+	
+TEST ( "Two producers three consumers test with huge pages", test9 )
+
+
+/**
+ * Allocating without waiting and with a timeout when the readers don't free the elements
+ */
+void test10 () {
+	isdl::ringqueue < int, int64_t, 32, 1 > queue;
+
+	auto first = queue.try_allocate ( 32 );
+	ASSERT_EQUAL ( first.has_value (), true, "Free elements are allocated without waiting" );
+	queue.commit ( *first, 32 );
+
+	ASSERT_EQUAL ( queue.try_allocate ( 1 ).has_value (), false, "Full queue is reported without waiting" );
+	ASSERT_EQUAL ( queue.allocate_for ( 1, std::chrono::milliseconds ( 10 ) ).has_value (), false,
+		"Allocation times out when the queue stays full" );
+
+	queue.free ( 0, 0, 4 );
+	auto index = queue.try_allocate ( 4 );
+	ASSERT_EQUAL ( index.has_value (), true, "Freed elements are allocated" );
+	ASSERT_EQUAL ( *index, 32, "Allocation continues after the last allocated index" );
+}
+
+TEST ( "Allocation without waiting test", test10 )
+
+
+/**
+ * Committed elements are counted across the end of the queue
+ */
+void test11 () {
+	isdl::ringqueue < int, int64_t, 32, 1 > queue;
+
+	queue.commit ( queue.allocate ( 20 ), 20 );
+	queue.free ( 0, 0, 20 );
+	ASSERT_EQUAL ( queue.committed ( 0 ), 20, "Committed elements are counted" );
+
+	int64_t index = queue.allocate ( 30 );
+	queue.commit ( index + 10, 20 );
+	ASSERT_EQUAL ( queue.committed ( index ), 0, "Elements committed out of order are not counted" );
+	queue.commit ( index, 10 );
+	ASSERT_EQUAL ( queue.committed ( index ), 30, "Committed elements wrapping the queue are counted" );
+	ASSERT_EQUAL ( queue.committed_elements (), 30, "Committed elements after the read index are counted" );
+	ASSERT_EQUAL ( queue.committed ( index + 7 ), 23, "Counting starts at any index" );
+}
+
+TEST ( "Committed elements wrapping the queue test", test11 )
+
+
+/**
+ * Readers wait for the committed elements and writers wait for the freed elements with the
+ * wait strategy of the queue
+ */
+template < typename WaitStrategy > void wait_strategy_test () {
+	isdl::ringqueue < int64_t, int64_t, 16, 2, WaitStrategy > queue;
+	int64_t sums[2] = { 0, 0 };
+	std::vector < std::thread > readers;
+	for ( size_t reader = 0; reader < 2; ++reader ) {
+		readers.push_back ( std::thread ( [&queue, &sums, reader] {
+			int64_t index = 0;
+			while ( index < 10000 ) {
+				size_t count = queue.wait_committed ( index );
+				for ( size_t element = 0; element < count; ++element ) {
+					sums[reader] += queue[index + element];
+				}
+				queue.free ( reader, index, count );
+				index += count;
+			}
+		} ) );
+	}
+	for ( int64_t value = 1; value <= 10000; value += 4 ) {
+		int64_t index = queue.allocate ( 4 );
+		for ( int64_t element = 0; element < 4; ++element ) {
+			queue[index + element] = value + element;
+		}
+		queue.commit ( index, 4 );
+	}
+	for ( std::thread& reader : readers ) {
+		reader.join ();
+	}
+	ASSERT_EQUAL ( sums[0], 10000 * 10001 / 2, "First reader receives all the elements" );
+	ASSERT_EQUAL ( sums[1], 10000 * 10001 / 2, "Second reader receives all the elements" );
+	ASSERT_EQUAL ( queue.available_size (), 16, "Readers free all the elements" );
+}
+
+void test12 () {
+	wait_strategy_test < isdl::blocking_wait_strategy > ();
+	wait_strategy_test < isdl::yielding_wait_strategy > ();
+}
+
+TEST ( "Waiting for committed elements test", test12 )
+
+
+/**
+ * Element counting its live instances
+ */
+struct counted_element {
+	static int live;
+	std::string _value;
+	counted_element () { ++live; }
+	counted_element ( const std::string& value ) : _value ( value ) { ++live; }
+	counted_element ( counted_element&& other ) : _value ( std::move ( other._value ) ) { ++live; }
+	~counted_element () { --live; }
+	void clear () { _value.clear (); }
+};
+
+int counted_element::live = 0;
+
+
+/**
+ * Queue sized at runtime with elements constructed in place, moved out and reused
+ */
+void test13 () {
+	bool thrown = false;
+	try {
+		isdl::dynamic_ringqueue < int, int64_t > queue ( 12, 1 );
+	} catch ( isdl::invalid_queue_parameter& ) {
+		thrown = true;
+	}
+	ASSERT_EQUAL ( thrown, true, "Size needs to be a power of two" );
+
+	{
+		isdl::dynamic_ringqueue < counted_element, int64_t > queue ( 4, 1 );
+		ASSERT_EQUAL ( counted_element::live, 0, "Elements are not constructed up front" );
+		ASSERT_EQUAL ( queue.size (), 4, "Size is set when constructed" );
+
+		int64_t index = queue.allocate ( 2 );
+		queue.emplace ( index, std::string ( 40, 'a' ) );
+		queue.emplace ( index + 1, "second" );
+		queue.commit ( index, 2 );
+		ASSERT_EQUAL ( queue.wait_committed ( index, 2 ), 2, "Emplaced elements are committed" );
+		counted_element first = queue.take ( index );
+		ASSERT_EQUAL ( first._value, std::string ( 40, 'a' ), "Element is moved out" );
+		ASSERT_EQUAL ( queue[index + 1]._value, "second", "Element is constructed in place" );
+		queue.free ( 0, index, 2 );
+		ASSERT_EQUAL ( counted_element::live, 3, "Elements stay in the slots until allocated again" );
+
+		for ( int round = 0; round < 3; ++round ) {
+			index = queue.allocate ( 4 );
+			for ( int64_t element = index; element < index + 4; ++element ) {
+				queue.emplace ( element, "round" );
+			}
+			queue.commit ( index, 4 );
+			queue.free ( 0, index, queue.wait_committed ( index, 4 ) );
+		}
+		ASSERT_EQUAL ( counted_element::live, 5, "Previous elements are destroyed when the slots are reused" );
+	}
+	ASSERT_EQUAL ( counted_element::live, 0, "Elements are destroyed with the queue" );
+
+	{
+		isdl::dynamic_ringqueue < std::string, int64_t > queue ( 8, 2, true );
+		const char *data = nullptr;
+		for ( int round = 0; round < 4; ++round ) {
+			int64_t index = queue.allocate ( 1 );
+			std::string& element = queue.reuse ( index );
+			ASSERT_EQUAL ( element.empty (), true, "Reused element is cleared" );
+			element.append ( 100, 'x' );
+			queue.commit ( index, 1 );
+			if ( round == 0 ) data = element.data ();
+			queue.free ( 0, index, 1 );
+			queue.free ( 1, index, 1 );
+			for ( int skip = 1; skip < 8; ++skip ) {
+				int64_t other = queue.allocate ( 1 );
+				queue.reuse ( other );
+				queue.commit ( other, 1 );
+				queue.free ( 0, other, 1 );
+				queue.free ( 1, other, 1 );
+			}
+		}
+		ASSERT_EQUAL ( ( queue[0].data () == data ), true, "Reused element keeps its memory" );
+		ASSERT_EQUAL ( queue.available_size (), 8, "Readers free the elements" );
+	}
+}
+
+TEST ( "Runtime sized queue test", test13 )
@@ -0,0 +1,124 @@
+#include <unittest>
+#include <shmdisruptor>
+#include <string>
+#include <sys/wait.h>
+
+
+struct shm_event {
+	int64_t _value;
+};
+
+using test_shm_disruptor = isdl::shm_disruptor < shm_event, int64_t >;
+
+static std::string shm_name ( const char *name ) {
+	return std::string ( "/isdl_test_" ) + name + "_" + std::to_string ( getpid () );
+}
+
+
+/**
+ * Producer and consumer attached to the same segment in one process, the consumer attached
+ * after the events are published still receives them
+ */
+void shmdisruptor1 () {
+	std::string name = shm_name ( "attach" );
+
+	struct EventHandler {
+		int64_t accumulated = 0;
+		int64_t events = 0;
+		bool event ( int64_t seq, shm_event& event ) {
+			accumulated += event._value;
+			++events;
+			return true;
+		}
+	} handler;
+
+	{
+		test_shm_disruptor producer ( name.c_str (), 1024, 1 );
+		for ( int64_t i = 1; i < 101; ++i ) {
+			int64_t seq = producer.next ();
+			producer[seq]._value = i;
+			producer.publish ( seq );
+		}
+
+		test_shm_disruptor consumer ( name.c_str (), 1024, 1 );
+		consumer.handle ( 0, handler );
+		ASSERT_EQUAL ( consumer.readers (), 1, "Reader is registered in the segment" );
+		for ( int64_t i = 101; i < 100001; ++i ) {
+			int64_t seq = producer.next ();
+			producer[seq]._value = i;
+			producer.publish ( seq );
+		}
+		producer.stop ();
+		consumer.join ();
+		ASSERT_EQUAL ( producer.readers (), 0, "Reader is unregistered after the stop event" );
+	}
+	test_shm_disruptor::unlink ( name.c_str () );
+
+	ASSERT_EQUAL ( handler.events, 100000, "Consumer receives the events published before attaching" );
+	ASSERT_EQUAL ( handler.accumulated, 100001L*50000L, "Consumer receives all the events" );
+
+	bool mismatch = false;
+	{
+		test_shm_disruptor producer ( name.c_str (), 1024, 1 );
+		try {
+			test_shm_disruptor consumer ( name.c_str (), 2048, 1 );
+		} catch ( isdl::invalid_operation& ) {
+			mismatch = true;
+		}
+	}
+	test_shm_disruptor::unlink ( name.c_str () );
+	ASSERT_EQUAL ( mismatch, true, "Attaching with a different geometry fails" );
+}
+
+TEST ( "Test shared memory disruptor attach", shmdisruptor1 );
+
+
+/**
+ * Producer in this process, two consumers in a child process
+ */
+void shmdisruptor2 () {
+	std::string name = shm_name ( "process" );
+	const int64_t events = 1000000;
+
+	struct EventHandler {
+		int64_t accumulated = 0;
+		bool event ( int64_t seq, shm_event& event ) {
+			accumulated += event._value;
+			return true;
+		}
+	};
+
+	pid_t child = fork ();
+	if ( child == 0 ) {
+		int status = 1;
+		{
+			EventHandler handler1, handler2;
+			test_shm_disruptor consumer ( name.c_str (), 1024, 2 );
+			consumer.handle ( 0, handler1 ).handle ( 1, handler2 );
+			consumer.join ();
+			if ( handler1.accumulated == ( events + 1 ) * events / 2 &&
+				handler2.accumulated == handler1.accumulated ) {
+				status = 0;
+			}
+		}
+		_exit ( status );
+	}
+
+	{
+		test_shm_disruptor producer ( name.c_str (), 1024, 2 );
+		for ( int64_t i = 1; i < events + 1; ++i ) {
+			int64_t seq = producer.next ();
+			producer[seq]._value = i;
+			producer.publish ( seq );
+		}
+		producer.stop ();
+	}
+	int status = -1;
+	waitpid ( child, &status, 0 );
+	test_shm_disruptor::unlink ( name.c_str () );
+
+	ASSERT_EQUAL ( WIFEXITED ( status ), true, "Consumer process exits" );
+	ASSERT_EQUAL ( WEXITSTATUS ( status ), 0, "Consumer process receives all the events" );
+}
+
+TEST ( "Test shared memory disruptor between processes", shmdisruptor2 );
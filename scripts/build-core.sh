@@ -43,4 +43,17 @@ LIBS="-lunittest -lpthread -lcore"
 
 make_bin obj/core/test bin/coretest
 
+echo "Building benchmarks"
+
+if [ ! -d obj/core/bench ]; then
+	echo "Crating object directory for benchmarks"
+	mkdir -p obj/core/bench
+fi
+
+INCLUDE="$INCLUDE -Icore/bench -Isrc/core" GCC_FLAGS="-O2 $BENCH_FLAGS" compile_all core/bench obj/core/bench
+
+LIBS="-lpthread -lcore"
+
+make_bin obj/core/bench bin/corebench
+
 LD_LIBRARY_PATH=$PWD/lib ./bin/coretest
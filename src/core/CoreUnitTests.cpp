@@ -2,6 +2,9 @@
 //
 
 #include <thread>
+#include <vector>
+#include <memory>
+#include <atomic>
 #include <gtest/gtest.h>
 #include "LocklessQueue.h"
 
@@ -170,6 +173,63 @@ namespace {
 		ASSERT_EQ ( consumerCount1+consumerCount2+consumerCount3, 3*producerCount );
 		ASSERT_EQ ( consumerSum1+consumerSum2+consumerSum3, producerSum1+producerSum2+producerSum3 );
 	}
+	TEST ( LocklessQueue, BulkEnqueueDequeue ) {
+
+		typedef isdl::LocklessQueue < unsigned long long, 64, isdl::MultiThreadedModel, isdl::MultiThreadedModel > Queue;
+		Queue *queue = new Queue ();
+		const unsigned long long producerCount = 100000;
+		std::atomic < unsigned long long > consumed ( 0 ), consumerSum ( 0 );
+
+		std::vector < std::thread > threads;
+		for ( int producer = 0; producer < 3; ++producer ) {
+			threads.push_back ( std::thread ( [queue, producerCount] {
+				unsigned long long values[16];
+				for ( unsigned long long next = 1; next <= producerCount; ) {
+					size_t count = 0;
+					for ( ; count < 16 && next + count <= producerCount; ++count ) {
+						values[count] = next + count;
+					}
+					next += queue->enqueue_bulk ( values, count );
+				}
+			} ) );
+		}
+		for ( int consumer = 0; consumer < 3; ++consumer ) {
+			threads.push_back ( std::thread ( [queue, producerCount, &consumed, &consumerSum] {
+				unsigned long long values[16];
+				while ( consumed.load () < 3 * producerCount ) {
+					size_t count = queue->dequeue_bulk ( values, 16 );
+					for ( size_t index = 0; index < count; ++index ) {
+						consumerSum += values[index];
+					}
+					consumed += count;
+				}
+			} ) );
+		}
+		for ( std::thread& thread : threads ) {
+			thread.join ();
+		}
+		ASSERT_EQ ( consumed.load (), 3 * producerCount );
+		ASSERT_EQ ( consumerSum.load (), 3 * producerCount * ( producerCount + 1 ) / 2 );
+		ASSERT_EQ ( queue->size (), 0u );
+		delete queue;
+	}
+
+	TEST ( LocklessQueue, MoveOnlyElements ) {
+
+		isdl::LocklessQueue < std::unique_ptr < int >, 4, isdl::SingleThreadedModel, isdl::SingleThreadedModel > queue;
+		ASSERT_EQ ( queue.capacity (), 4u );
+		for ( int value = 0; value < 4; ++value ) {
+			ASSERT_TRUE ( queue.enqueue ( std::unique_ptr < int > ( new int ( value ) ) ) );
+		}
+		ASSERT_FALSE ( queue.enqueue ( std::unique_ptr < int > ( new int ( 4 ) ) ) );
+
+		std::unique_ptr < int > values[4];
+		ASSERT_EQ ( queue.dequeue_bulk ( values, 4 ), 4u );
+		for ( int value = 0; value < 4; ++value ) {
+			ASSERT_EQ ( *values[value], value );
+		}
+		ASSERT_FALSE ( queue.dequeue ( values[0] ) );
+	}
 }
 
 int main ( int argc, char *argv[] ) {
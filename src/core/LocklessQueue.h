@@ -1,6 +1,10 @@
 /// Queue template definitions
 #pragma once
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
 
 namespace isdl {
 
@@ -26,129 +30,154 @@ template < > struct SizeBitShift < 0 > {
 	enum { value = 0, index = 0 };
 };
 
-/// Policy classes to define different behaviour
-
-
-
-template < size_t RING_MASK, size_t SHIFT_INDEX, typename T, typename ThreadingModel > class QueueIndex {
-};
 
+/**
+ *@brief Bounded queue passing every element to exactly one consumer.
+ *
+ * Every slot carries a sequence stamp telling which position it is ready for. A producer
+ * writes the slot of position p only when the stamp is p, and stamps it p + 1 when the element
+ * is written. A consumer reads it only when the stamp is p + 1, and stamps it p + ARRAY_SIZE
+ * when the element is moved out. So a slow consumer still reading a slot can't be overwritten
+ * by a producer which wrapped around the queue. The producers and the consumers claim a range
+ * of positions with one atomic step, the multi threaded model claims with compare and swap and
+ * the single threaded model with a plain store.
+ *
+ *@param T is the element type, moved in and out of the queue
+ *@param MAX_SIZE is the minimum capacity, rounded up to power of two
+ *@param ProducerModel is MultiThreadedModel if more threads enqueue, SingleThreadedModel otherwise
+ *@param ConsumerModel is MultiThreadedModel if more threads dequeue, SingleThreadedModel otherwise
+ */
+template < typename T, size_t MAX_SIZE, typename ProducerModel, typename ConsumerModel > class LocklessQueue {
 
-template < size_t RING_MASK, size_t SHIFT_INDEX, typename T > class QueueIndex < RING_MASK, SHIFT_INDEX, T, SingleThreadedModel> {
-	T _index;
-	std::atomic < T > _size;
-public:
-	QueueIndex ( T initialSize ) : _index ( 0 ), _size ( initialSize ) {}
-	inline bool incrementIndex ( T& index ) {
-		if ( ! _size  )
-			return false;
-		--_size;
-		index = _index & RING_MASK;
-		++_index;
-	 	return true; 
+	static const size_t SHIFT_INDEX = SizeBitShift < MAX_SIZE - 1 >::index;
+	static const size_t ARRAY_SIZE = size_t ( 1 ) << SHIFT_INDEX;
+	static const size_t RING_MASK = ARRAY_SIZE - 1;
+	/// Head and tail are written by the producers and the consumers, each on its own cache line
+	static const size_t CACHE_LINE = 64;
+
+	struct Slot {
+		std::atomic < size_t > _sequence;
+		T _item;
+	};
+
+	alignas ( CACHE_LINE ) std::atomic < size_t > _head;			///< Next position to enqueue
+	alignas ( CACHE_LINE ) std::atomic < size_t > _tail;			///< Next position to dequeue
+	alignas ( CACHE_LINE ) Slot _slots [ ARRAY_SIZE ];
+
+	/**
+	 *@brief Counts the consecutive slots ready for the positions starting at position
+	 *@param offset is the difference between the stamp of a ready slot and its position
+	 */
+	size_t _ready ( size_t position, size_t count, size_t offset ) const {
+		size_t ready = 0;
+		for ( ; ready < count && _slots[( position + ready ) & RING_MASK]._sequence.load (
+			std::memory_order_acquire ) == position + ready + offset; ++ready );
+		return ready;
 	}
 
-	inline T commitIndex () { return 1; }
-	
-	inline void updateIndex ( T increment ) {
-		_size += increment;
+	size_t _claim ( std::atomic < size_t >& index, size_t& position, size_t count, size_t offset,
+		MultiThreadedModel ) {
+		position = index.load ( std::memory_order_relaxed );
+		while ( true ) {
+			size_t ready = _ready ( position, count, offset );
+			if ( ready ) {
+				if ( index.compare_exchange_weak ( position, position + ready, std::memory_order_relaxed ) ) {
+					return ready;
+				}
+				continue;
+			}
+			/// The slot is not ready, either the queue is full or empty or another thread
+			/// claimed the position already
+			size_t current = index.load ( std::memory_order_relaxed );
+			if ( current == position ) {
+				return 0;
+			}
+			position = current;
+		}
 	}
-	
-	
-};
 
-
-template < size_t RING_MASK, size_t SHIFT_INDEX, typename T > class QueueIndex < RING_MASK, SHIFT_INDEX, T, MultiThreadedModel > {
-
-	std::atomic < T > _runningIndex;			///< Running index 
-	std::atomic < T > _committedIndex;			///< CommittedIndex
+	size_t _claim ( std::atomic < size_t >& index, size_t& position, size_t count, size_t offset,
+		SingleThreadedModel ) {
+		position = index.load ( std::memory_order_relaxed );
+		size_t ready = _ready ( position, count, offset );
+		index.store ( position + ready, std::memory_order_relaxed );
+		return ready;
+	}
 
 public:
-	QueueIndex ( T initialSize ) :
-		 _runningIndex ( initialSize ), _committedIndex ( 0 ) {}
-
-	inline bool incrementIndex ( T& index ) {
-		T newIndex;
-		do {
-			/// Check if we have enough elements to write in the queue
-			index = _runningIndex;
-			if ( ! ( index & RING_MASK ) )
-				return false;
-			/// Increment head index and decrement write size in one shot
-			newIndex = index + RING_MASK;
-			
-		} while ( ! _runningIndex.compare_exchange_weak ( index, newIndex ) );
-		index = (index>>SHIFT_INDEX)&RING_MASK;
-		return true;
+	LocklessQueue ( ) : _head ( 0 ), _tail ( 0 ) {
+		for ( size_t index = 0; index < ARRAY_SIZE; ++index ) {
+			_slots[index]._sequence.store ( index, std::memory_order_relaxed );
+		}
 	}
 
-
-	inline T commitIndex () {
-		/// Commit the write
-		T committedIndex, index, commitSize, newIndex;
-
-		++_committedIndex;
-		/// Check if we can update tail to signal arival of more elements
-		do {
-			///Synchronize head atomic with committed head
-			do {
-				index = _runningIndex;
-				committedIndex = _committedIndex;
-			}while ( index != _runningIndex );
-			commitSize = committedIndex & RING_MASK;
-			if ( commitSize + ( committedIndex >> SHIFT_INDEX ) < index >> SHIFT_INDEX )
-				return 0;
-			newIndex = committedIndex + ( commitSize << SHIFT_INDEX ) - commitSize; 
-		} while ( !_committedIndex.compare_exchange_weak ( committedIndex, newIndex ) );
-		return commitSize;
-		
-
+	LocklessQueue ( const LocklessQueue& ) = delete;
+
+	LocklessQueue& operator = ( const LocklessQueue& ) = delete;
+
+	/**
+	 *@brief Enqueues up to count elements with one claim, the elements are assigned from the
+	 * 	iterator so a move iterator moves them into the queue
+	 *@param first is the iterator to the first element
+	 *@param count is the maximum number of elements to enqueue
+	 *@return the number of enqueued elements, less than count if the queue is full
+	 */
+	template < typename Iterator > size_t enqueue_bulk ( Iterator first, size_t count ) {
+		size_t position;
+		size_t claimed = _claim ( _head, position, count, 0, ProducerModel () );
+		for ( size_t index = 0; index < claimed; ++index, ++first ) {
+			Slot& slot = _slots[( position + index ) & RING_MASK];
+			slot._item = *first;
+			slot._sequence.store ( position + index + 1, std::memory_order_release );
+		}
+		return claimed;
 	}
-	
-	inline void updateIndex ( T count ) {
-		_runningIndex += count;
-	}
-};
-
-
-
-template < typename T, size_t MAX_SIZE, typename ProducerModel, typename ConsumerModel > class LocklessQueue {
-
-	static const size_t SHIFT_INDEX = SizeBitShift < MAX_SIZE >::index;
-	static const size_t ARRAY_SIZE = 1<<SHIFT_INDEX;
-	static const size_t RING_MASK = ARRAY_SIZE - 1;
-	T _items [ ARRAY_SIZE ];
-	QueueIndex < RING_MASK, SHIFT_INDEX, unsigned long long, ProducerModel > _head; 
-	QueueIndex < RING_MASK, SHIFT_INDEX, unsigned long long, ConsumerModel > _tail; 
-
-public:
-	LocklessQueue ( ) : _head ( MAX_SIZE ), _tail( 0 ) { }
-
 
+	/**
+	 *@brief Dequeues up to max_count elements with one claim, the elements are moved out
+	 *@param out is the output iterator receiving the elements
+	 *@param max_count is the maximum number of elements to dequeue
+	 *@return the number of dequeued elements, 0 if the queue is empty
+	 */
+	template < typename OutputIterator > size_t dequeue_bulk ( OutputIterator out, size_t max_count ) {
+		size_t position;
+		size_t claimed = _claim ( _tail, position, max_count, 1, ConsumerModel () );
+		for ( size_t index = 0; index < claimed; ++index, ++out ) {
+			Slot& slot = _slots[( position + index ) & RING_MASK];
+			*out = std::move ( slot._item );
+			slot._sequence.store ( position + index + ARRAY_SIZE, std::memory_order_release );
+		}
+		return claimed;
+	}
 
 	bool enqueue ( const T& item ) {
-		unsigned long long index;
-		if ( ! _head.incrementIndex( index ) )
-			return false;
-		_items[index] = item;
-		index = _head.commitIndex ();
-		_tail.updateIndex ( index );
-		return true;
+		return enqueue_bulk ( &item, 1 ) == 1;
+	}
 
+	bool enqueue ( T&& item ) {
+		return enqueue_bulk ( std::make_move_iterator ( &item ), 1 ) == 1;
 	}
 
 	bool dequeue ( T& item ) {
-		unsigned long long index;
-		if ( ! _tail.incrementIndex( index ) )
-			return false;
-		item = _items[index];
-		index = _tail.commitIndex ();
-		_head.updateIndex ( index );
-		return true;
+		return dequeue_bulk ( &item, 1 ) == 1;
 	}
 
-};
+	/**
+	 *@brief returns the number of elements the queue can hold
+	 */
+	static constexpr size_t capacity () {
+		return ARRAY_SIZE;
+	}
 
-}
+	/**
+	 *@brief returns the number of claimed elements, exact only if no thread enqueues or dequeues
+	 */
+	size_t size () const {
+		size_t tail = _tail.load ( std::memory_order_relaxed );
+		size_t head = _head.load ( std::memory_order_relaxed );
+		return head > tail ? head - tail : 0;
+	}
 
+};
 
+}